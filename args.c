@@ -22,6 +22,7 @@
  * SOFTWARE.
  ******************************************************************************/
 
+#include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -30,11 +31,40 @@
 #include "args.h"
 #include "console.h"
 
-int               current_arg_index = 1;
-CliOptionGroup_t *options_registry[MAX_OPTION_GROUPS];
-bool              arg_ledger[MAX_CLI_ARGS] = {false};
-int               num_registered_options   = 0;
-CliOptions_t     *last_options_parsed      = NULL;
+int                current_arg_index      = 1;
+CliOptionGroup_t **options_registry       = NULL;
+int                options_registry_size  = 0;
+int                num_registered_options = 0;
+CliOptions_t      *last_options_parsed    = NULL;
+
+/* Argument ledger, a bitset of the arguments parsed so far (grown to fit argc as needed, bits past it are never set) */
+static uint64_t *arg_ledger       = NULL;
+static size_t    arg_ledger_words = 0;
+
+#define ARGS_FUNCTION_GROUP (INT_MAX) ///< Group order of a function's options, they're parsed after the registry's
+
+/**
+ * @brief   An entry of the option name index, naming an option of a registered options array.
+ */
+typedef struct ArgsIndexEntry
+{
+    uint64_t          hash;        ///< Hash of the option's name
+    CliOptions_t     *options;     ///< The options array the option belongs to
+    CliOptions_t     *option;      ///< The option itself, NULL for an empty slot
+    CliOptionGroup_t *group;       ///< The group the option belongs to
+    int               group_order; ///< Position of the group in the options registry, ARGS_FUNCTION_GROUP for a function's options
+} ArgsIndexEntry_t;
+
+/* Option name index, an open addressed hash table filled by args_register_options() (size is a power of two, at most
+ * half full). Names are hashed alone so that an option's entry is found from its name and options array. */
+static ArgsIndexEntry_t *options_index        = NULL;
+static size_t            options_index_size   = 0;
+static size_t            options_index_length = 0;
+
+/* Options of type OPTION_TYPE_FUNC_PTR that have a group of function options registered with them */
+static CliOptions_t **function_options_registry      = NULL;
+static int            function_options_registry_size = 0;
+static int            num_registered_functions       = 0;
 
 /* String representations of the option types */
 const char *opt_type_strings[] = {
@@ -54,6 +84,320 @@ const char *opt_type_strings[] = {
     "FUNC_PTR",  // OPTION_TYPE_FUNC_PTR
 };
 
+/**
+ * @brief   Make sure the argument ledger has room for argc arguments, keeping the arguments marked so far.
+ *
+ * @param argc      The count of arguments
+ * @return true     The ledger is large enough
+ * @return false    We ran out of memory
+ */
+static bool args_ledger_reserve_internal(int argc)
+{
+    size_t words = ((size_t)argc + 63) / 64;
+
+    if (words > arg_ledger_words)
+    {
+        uint64_t *new_ledger = (uint64_t *)realloc(arg_ledger, words * sizeof(uint64_t));
+
+        if (!new_ledger)
+        {
+            return false;
+        }
+        memset(&new_ledger[arg_ledger_words], 0, (words - arg_ledger_words) * sizeof(uint64_t));
+        arg_ledger       = new_ledger;
+        arg_ledger_words = words;
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Mark an argument as parsed in the argument ledger.
+ */
+static void args_ledger_set_internal(int arg_index)
+{
+    arg_ledger[arg_index / 64] |= 1ull << (arg_index % 64);
+}
+
+/**
+ * @brief   Find the first argument from arg_index on that isn't marked as parsed, a word of the ledger at a time.
+ *
+ * @param arg_index     The argument to start from
+ * @param argc          The count of arguments
+ * @return int          The argument's index, argc if they're all parsed
+ */
+static int args_ledger_find_unset_internal(int arg_index, int argc)
+{
+    size_t   word_index = (size_t)arg_index / 64;
+    uint64_t unset;
+
+    if (arg_index >= argc)
+    {
+        return argc;
+    }
+
+    /* Bits before arg_index in its word count as set */
+    unset = ~arg_ledger[word_index] & (~0ull << (arg_index % 64));
+    while (!unset)
+    {
+        if (++word_index * 64 >= (size_t)argc)
+        {
+            return argc;
+        }
+        unset = ~arg_ledger[word_index];
+    }
+
+#if defined(__GNUC__)
+    arg_index = (int)(word_index * 64) + __builtin_ctzll(unset);
+#else
+    for (arg_index = (int)(word_index * 64); !(unset & 1); unset >>= 1)
+    {
+        arg_index++;
+    }
+#endif
+
+    return (arg_index < argc) ? arg_index : argc;
+}
+
+/**
+ * @brief   FNV-1a hash of an option name.
+ */
+static uint64_t args_hash_internal(const char *name)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    while (*name)
+    {
+        hash ^= (uint8_t)*name++;
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief   Find the slot for an option in the option name index, either the entry holding it or the empty slot it
+ *          would go in.
+ */
+static ArgsIndexEntry_t *args_index_slot_internal(ArgsIndexEntry_t *index, size_t index_size, const char *name, CliOptions_t *options, uint64_t hash)
+{
+    size_t slot = (size_t)hash & (index_size - 1);
+
+    while (index[slot].option && ((index[slot].hash != hash) || (index[slot].options != options) || strcmp(index[slot].option->name, name)))
+    {
+        slot = (slot + 1) & (index_size - 1);
+    }
+
+    return &index[slot];
+}
+
+/**
+ * @brief   Add an option group to the option name index, growing it as needed. Options already indexed are left as
+ *          they are, so the first of several options sharing a name is the one found, as with a linear search.
+ *
+ * @param group         The option group to index
+ * @param group_order   The group's position in the options registry, ARGS_FUNCTION_GROUP for a function's options
+ * @return true         The group was indexed
+ * @return false        We ran out of memory
+ */
+static bool args_index_add_internal(CliOptionGroup_t *group, int group_order)
+{
+    CliOptions_t *options = group->options;
+
+    for (int i = 0; options[i].name != 0; i++)
+    {
+        uint64_t          hash = args_hash_internal(options[i].name);
+        ArgsIndexEntry_t *entry;
+
+        if ((options_index_length + 1) * 2 > options_index_size)
+        {
+            size_t            new_size  = options_index_size ? (options_index_size * 2) : 64;
+            ArgsIndexEntry_t *new_index = (ArgsIndexEntry_t *)calloc(new_size, sizeof(ArgsIndexEntry_t));
+
+            if (!new_index)
+            {
+                return false;
+            }
+            for (size_t j = 0; j < options_index_size; j++)
+            {
+                if (options_index[j].option)
+                {
+                    *args_index_slot_internal(new_index, new_size, options_index[j].option->name, options_index[j].options, options_index[j].hash) = options_index[j];
+                }
+            }
+            free(options_index);
+            options_index      = new_index;
+            options_index_size = new_size;
+        }
+
+        entry = args_index_slot_internal(options_index, options_index_size, options[i].name, options, hash);
+        if (!entry->option)
+        {
+            entry->hash        = hash;
+            entry->options     = options;
+            entry->option      = &options[i];
+            entry->group       = group;
+            entry->group_order = group_order;
+            options_index_length++;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Resolve a command line option name through the option name index. The option has to be one that's still to
+ *          be parsed, of a group in the options registry or of the function's group. When several groups have an option
+ *          by that name the earliest group gets it, the function's group coming last.
+ *
+ * @param name                  The option name, without its dashes
+ * @param function_group        The options of the function being parsed for, NULL if there's none
+ * @param group_limit           Only registry groups before this position can be matched, ARGS_FUNCTION_GROUP for all of
+ *                              them
+ * @param function_pointers     Whether function pointer options can be matched, only the first one on the command line
+ *                              is ours
+ * @return ArgsIndexEntry_t*    The option's entry, NULL if there's no such option left to parse
+ */
+static ArgsIndexEntry_t *args_index_resolve_internal(const char *name, const CliOptionGroup_t *function_group, int group_limit, bool function_pointers)
+{
+    uint64_t          hash  = args_hash_internal(name);
+    ArgsIndexEntry_t *found = NULL;
+
+    if (!options_index)
+    {
+        return NULL;
+    }
+
+    /* Options sharing a name all sit in the run of slots from the name's home slot up to the first empty one */
+    for (size_t slot = (size_t)hash & (options_index_size - 1); options_index[slot].option; slot = (slot + 1) & (options_index_size - 1))
+    {
+        ArgsIndexEntry_t *entry = &options_index[slot];
+
+        if ((entry->hash != hash) || entry->option->is_parsed || strcmp(entry->option->name, name))
+        {
+            continue;
+        }
+        if ((entry->group_order == ARGS_FUNCTION_GROUP) ? (entry->group != function_group) : (entry->group_order >= group_limit))
+        {
+            continue;
+        }
+        if ((entry->option->option_type == OPTION_TYPE_FUNC_PTR) && !function_pointers)
+        {
+            continue;
+        }
+        if (!found || (entry->group_order < found->group_order))
+        {
+            found = entry;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief   Store a parsed option's value in its destination.
+ *
+ * @param option    The option that was parsed
+ * @param argument  The option's argument, NULL for a flag
+ * @return true     The value was stored
+ * @return false    The option type isn't one that holds a value
+ */
+static bool args_store_value_internal(CliOptions_t *option, const char *argument)
+{
+    switch (option->option_type)
+    {
+        case OPTION_TYPE_FLAG:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a flag argument %s", __FUNCTION__, option->name);
+            ARGS_OPTION_VALUE(option, bool) = true;
+            break;
+        case OPTION_TYPE_STRING:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a string argument %s", __FUNCTION__, argument);
+            strncpy((char *)(option->destination), argument, MAX_PARSED_STRING_LEN);
+            break;
+        case OPTION_TYPE_ENUM:
+            // Copy integer, and add one. Enums always start with a null value,
+            // so we offset by one to zero index the first item.
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found an enum argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, int) = atoi(argument) + 1;
+            break;
+        case OPTION_TYPE_FLOAT:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a float argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, int) = atof(argument);
+            break;
+        case OPTION_TYPE_INT:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a decimal int argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, int) = atoi(argument);
+            break;
+        case OPTION_TYPE_UINT:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a decimal unsigned int argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, unsigned int) = atoi(argument);
+            break;
+        case OPTION_TYPE_UINT32:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a decimal uint32 argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, uint32_t) = (uint32_t)atoi(argument);
+            break;
+        case OPTION_TYPE_UINT64:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a decimal uint64 argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, uint64_t) = (uint64_t)atoll(argument);
+            break;
+        case OPTION_TYPE_HEXUINT8:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a hexadecimal uint8 argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, uint8_t) = strtoul(argument, NULL, 16);
+            break;
+        case OPTION_TYPE_HEXUINT16:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a hexadecimal uint16 argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, uint16_t) = strtoul(argument, NULL, 16);
+            break;
+        case OPTION_TYPE_HEXUINT32:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a hexadecimal uint32 argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, uint32_t) = strtoul(argument, NULL, 16);
+            break;
+        case OPTION_TYPE_HEXUINT64:
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a hexadecimal uint64 argument %s", __FUNCTION__, argument);
+            ARGS_OPTION_VALUE(option, uint64_t) = strtoul(argument, NULL, 16);
+            break;
+        case OPTION_TYPE_FUNC_PTR:
+        case OPTION_TYPE_NONE:
+        default:
+            console_print_error(LOGGING_LEVEL_0, "%s: Unexpected argument type %d. Aborting.", __FUNCTION__, option->option_type);
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Get an option by name. Options of registered groups are found through the option name index, anything else
+ *          is searched for. The option returned stays valid for as long as its options array does, so code reading an
+ *          option repeatedly can look it up once and use ARGS_OPTION_VALUE() on it from then on.
+ *
+ * @param name              The name of the option (for lookup)
+ * @param options           The list of options to look through
+ * @return CliOptions_t*    The option, NULL if there's no option by that name
+ */
+CliOptions_t *args_get_option(const char *name, CliOptions_t *options)
+{
+    if (options_index)
+    {
+        ArgsIndexEntry_t *entry = args_index_slot_internal(options_index, options_index_size, name, options, args_hash_internal(name));
+
+        if (entry->option)
+        {
+            return entry->option;
+        }
+    }
+
+    for (int i = 0; options[i].name != 0; i++)
+    {
+        if (strcmp(options[i].name, name) == 0)
+        {
+            return &options[i];
+        }
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Set an OPTION_TYPE_FLAG option to a value.
  *
@@ -63,13 +407,11 @@ const char *opt_type_strings[] = {
  */
 void args_set_flag_value(const char *name, CliOptions_t *options, int value)
 {
-    for (int i = 0; options[i].name != 0; i++)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            (*((bool *)(options[i].destination))) = value;
-            break;
-        }
+        ARGS_OPTION_VALUE(option, bool) = value;
     }
 }
 
@@ -82,13 +424,11 @@ void args_set_flag_value(const char *name, CliOptions_t *options, int value)
  */
 void args_set_string_value(const char *name, CliOptions_t *options, const char *value)
 {
-    for (int i = 0; options[i].name != 0; i++)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            strcpy((char *)(options[i].destination), value);
-            break;
-        }
+        strcpy((char *)(option->destination), value);
     }
 }
 
@@ -101,13 +441,11 @@ void args_set_string_value(const char *name, CliOptions_t *options, const char *
  */
 void args_set_enum_value(const char *name, CliOptions_t *options, int value)
 {
-    for (int i = 0; options[i].name != 0; i++)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            (*((int *)(options[i].destination))) = value;
-            break;
-        }
+        ARGS_OPTION_VALUE(option, int) = value;
     }
 }
 
@@ -120,13 +458,11 @@ void args_set_enum_value(const char *name, CliOptions_t *options, int value)
  */
 void args_set_int_value(const char *name, CliOptions_t *options, int value)
 {
-    for (int i = 0; options[i].name != 0; i++)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            (*((int *)(options[i].destination))) = value;
-            break;
-        }
+        ARGS_OPTION_VALUE(option, int) = value;
     }
 }
 
@@ -139,13 +475,11 @@ void args_set_int_value(const char *name, CliOptions_t *options, int value)
  */
 void args_set_u_int8_value(const char *name, CliOptions_t *options, uint8_t value)
 {
-    for (int i = 0; options[i].name != 0; i++)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            (*((uint8_t *)(options[i].destination))) = value;
-            break;
-        }
+        ARGS_OPTION_VALUE(option, uint8_t) = value;
     }
 }
 
@@ -158,13 +492,11 @@ void args_set_u_int8_value(const char *name, CliOptions_t *options, uint8_t valu
  */
 void args_set_u_int16_value(const char *name, CliOptions_t *options, uint16_t value)
 {
-    for (int i = 0; options[i].name != 0; i++)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            (*((uint16_t *)(options[i].destination))) = value;
-            break;
-        }
+        ARGS_OPTION_VALUE(option, uint16_t) = value;
     }
 }
 
@@ -177,13 +509,11 @@ void args_set_u_int16_value(const char *name, CliOptions_t *options, uint16_t va
  */
 void args_set_u_int32_value(const char *name, CliOptions_t *options, uint32_t value)
 {
-    for (int i = 0; options[i].name != 0; i++)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            (*((uint32_t *)(options[i].destination))) = value;
-            break;
-        }
+        ARGS_OPTION_VALUE(option, uint32_t) = value;
     }
 }
 
@@ -196,13 +526,11 @@ void args_set_u_int32_value(const char *name, CliOptions_t *options, uint32_t va
  */
 void args_set_u_int64_value(const char *name, CliOptions_t *options, uint64_t value)
 {
-    for (int i = 0; options[i].name != 0; i++)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            (*((uint64_t *)(options[i].destination))) = value;
-            break;
-        }
+        ARGS_OPTION_VALUE(option, uint64_t) = value;
     }
 }
 
@@ -215,15 +543,9 @@ void args_set_u_int64_value(const char *name, CliOptions_t *options, uint64_t va
  */
 void *args_get_option_destination_pointer(const char *name, CliOptions_t *options)
 {
-    for (int i = 0; options[i].name != 0; i++)
-    {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            return options[i].destination;
-        }
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return 0;
+    return option ? option->destination : NULL;
 }
 
 /**
@@ -235,15 +557,9 @@ void *args_get_option_destination_pointer(const char *name, CliOptions_t *option
  */
 int args_get_flag_value(const char *name, CliOptions_t *options)
 {
-    for (int i = 0; options[i].name != 0; i++)
-    {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            return (*((bool *)(options[i].destination)));
-        }
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return 0;
+    return option ? ARGS_OPTION_VALUE(option, bool) : 0;
 }
 
 /**
@@ -255,15 +571,9 @@ int args_get_flag_value(const char *name, CliOptions_t *options)
  */
 const char *args_get_string_value(const char *name, CliOptions_t *options)
 {
-    for (int i = 0; options[i].name != 0; i++)
-    {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            return (char *)(options[i].destination);
-        }
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return NULL;
+    return option ? (const char *)(option->destination) : NULL;
 }
 
 /**
@@ -275,15 +585,9 @@ const char *args_get_string_value(const char *name, CliOptions_t *options)
  */
 int args_get_enum_value(const char *name, CliOptions_t *options)
 {
-    for (int i = 0; options[i].name != 0; i++)
-    {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            return (*((int *)(options[i].destination)));
-        }
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return 0;
+    return option ? ARGS_OPTION_VALUE(option, int) : 0;
 }
 
 /**
@@ -295,15 +599,9 @@ int args_get_enum_value(const char *name, CliOptions_t *options)
  */
 int args_get_int_value(const char *name, CliOptions_t *options)
 {
-    for (int i = 0; options[i].name != 0; i++)
-    {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            return (*((int *)(options[i].destination)));
-        }
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return 0;
+    return option ? ARGS_OPTION_VALUE(option, int) : 0;
 }
 
 /**
@@ -315,15 +613,9 @@ int args_get_int_value(const char *name, CliOptions_t *options)
  */
 uint8_t args_get_u_int8_value(const char *name, CliOptions_t *options)
 {
-    for (int i = 0; options[i].name != 0; i++)
-    {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            return (*((uint8_t *)(options[i].destination)));
-        }
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return 0;
+    return option ? ARGS_OPTION_VALUE(option, uint8_t) : 0;
 }
 
 /**
@@ -335,15 +627,9 @@ uint8_t args_get_u_int8_value(const char *name, CliOptions_t *options)
  */
 uint16_t args_get_u_int16_value(const char *name, CliOptions_t *options)
 {
-    for (int i = 0; options[i].name != 0; i++)
-    {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            return (*((uint16_t *)(options[i].destination)));
-        }
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return 0;
+    return option ? ARGS_OPTION_VALUE(option, uint16_t) : 0;
 }
 
 /**
@@ -355,15 +641,9 @@ uint16_t args_get_u_int16_value(const char *name, CliOptions_t *options)
  */
 uint32_t args_get_u_int32_value(const char *name, CliOptions_t *options)
 {
-    for (int i = 0; options[i].name != 0; i++)
-    {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            return (*((uint32_t *)(options[i].destination)));
-        }
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return 0;
+    return option ? ARGS_OPTION_VALUE(option, uint32_t) : 0;
 }
 
 /**
@@ -375,16 +655,9 @@ uint32_t args_get_u_int32_value(const char *name, CliOptions_t *options)
  */
 uint64_t args_get_u_int64_value(const char *name, CliOptions_t *options)
 {
-    for (int i = 0; options[i].name != 0; i++)
-    {
-        if (strcmp(options[i].name, name) == 0)
-        {
-            return (*((uint64_t *)(options[i].destination)));
-            ;
-        }
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return 0;
+    return option ? ARGS_OPTION_VALUE(option, uint64_t) : 0;
 }
 
 /**
@@ -425,15 +698,11 @@ void args_set_all_parsed(CliOptions_t *options, bool state)
  */
 void args_set_parsed(CliOptions_t *options, const char *name, bool state)
 {
-    unsigned int index = 0;
-    while (options[index].name != 0)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[index].name, name) == 0)
-        {
-            options[index].is_parsed = state;
-            break;
-        }
-        index++;
+        option->is_parsed = state;
     }
 }
 
@@ -446,23 +715,19 @@ void args_set_parsed(CliOptions_t *options, const char *name, bool state)
  */
 void args_set_defined(CliOptions_t *options, const char *name, bool state)
 {
-    unsigned int index = 0;
-    while (options[index].name != 0)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option)
     {
-        if (strcmp(options[index].name, name) == 0)
+        if (option->is_defined_ptr != NULL)
         {
-            if (options[index].is_defined_ptr != NULL)
-            {
-                *options[index].is_defined_ptr = state;
-                console_print_debug(LOGGING_LEVEL_1, "%s: Option \"%s\" set as defined through its pointer @ 0x%p.", __func__, name, options[index].is_defined_ptr);
-            }
-            else
-            {
-                console_print_warn(LOGGING_LEVEL_1, "%s: Option \"%s\" does not have a defined flag variable associated! Cannot set to defined state.", __func__, name);
-            }
-            break;
+            *option->is_defined_ptr = state;
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Option \"%s\" set as defined through its pointer @ 0x%p.", __func__, name, option->is_defined_ptr);
+        }
+        else
+        {
+            CONSOLE_PRINT_WARN(LOGGING_LEVEL_1, "%s: Option \"%s\" does not have a defined flag variable associated! Cannot set to defined state.", __func__, name);
         }
-        index++;
     }
 }
 
@@ -496,19 +761,9 @@ bool args_check_all_parsed(CliOptions_t *options)
  */
 bool args_check_parsed(CliOptions_t *options, const char *name)
 {
-    unsigned int index         = 0;
-    bool         option_parsed = false;
-    while (options[index].name != 0)
-    {
-        if (strcmp(options[index].name, name) == 0)
-        {
-            option_parsed = options[index].is_parsed;
-            break;
-        }
-        index++;
-    }
+    CliOptions_t *option = args_get_option(name, options);
 
-    return option_parsed;
+    return option ? option->is_parsed : false;
 }
 
 /**
@@ -545,21 +800,11 @@ bool args_check_pointers(CliOptions_t *options)
  */
 bool args_check_defined(CliOptions_t *options, const char *name)
 {
-    unsigned int index = 0;
-    while (options[index].name != 0)
+    CliOptions_t *option = args_get_option(name, options);
+
+    if (option && (option->is_defined_ptr != NULL))
     {
-        if (strcmp(options[index].name, name) == 0)
-        {
-            if (options[index].is_defined_ptr != NULL)
-            {
-                return *options[index].is_defined_ptr;
-            }
-            else
-            {
-                return false;
-            }
-        }
-        index++;
+        return *option->is_defined_ptr;
     }
 
     return false;
@@ -698,6 +943,35 @@ void args_print_help(ConsoleFunctionPointer_t function)
     console_print_new_line(LOGGING_LEVEL_0);
 }
 
+/**
+ * @brief   Make sure a registry has room for length entries, doubling it as needed.
+ *
+ * @param registry          The registry, NULL if it's empty
+ * @param registry_size     The number of entries the registry has room for, updated if it grows
+ * @param length            The number of entries needed
+ * @param entry_size        The size of an entry
+ * @return void*            The registry, NULL if we ran out of memory (the registry is left as it was)
+ */
+static void *args_registry_reserve_internal(void *registry, int *registry_size, int length, size_t entry_size)
+{
+    void *new_registry;
+    int   new_size;
+
+    if (length <= *registry_size)
+    {
+        return registry;
+    }
+
+    new_size     = *registry_size ? (*registry_size * 2) : 16;
+    new_registry = realloc(registry, (size_t)new_size * entry_size);
+    if (new_registry)
+    {
+        *registry_size = new_size;
+    }
+
+    return new_registry;
+}
+
 /**
  * @brief   This function registers an options group with the central registry. If a function pointer is passed it, the
  *          group is instead associated with the option that matches the same function pointer in the options registry.
@@ -711,101 +985,134 @@ void args_register_options(CliOptionGroup_t *option_group, ConsoleFunctionPointe
     bool          fatal_error                = false;
     CliOptions_t *parent_function_option     = NULL;
     CliOptions_t *options                    = NULL;
+    void         *registry                   = NULL;
     bool          function_option_registered = false;
     int           index                      = 0;
 
-    console_print_debug(LOGGING_LEVEL_1, "%s: Attempting to register \"%s\" to options registry", __FUNCTION__, option_group->name);
-    if (num_registered_options >= MAX_OPTION_GROUPS)
-    {
-        console_print_error(LOGGING_LEVEL_0, "%s: Fatal error: can't register any more option groups!", __FUNCTION__);
-        fatal_error = true;
-    }
-    else
+    CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Attempting to register \"%s\" to options registry", __FUNCTION__, option_group->name);
+
+    /* Perform a sanity check on the options */
+    options = option_group->options;
+    index   = 0;
+    while (options[index].name)
     {
-        /* Perform a sanity check on the options */
-        options = option_group->options;
-        index   = 0;
-        while (options[index].name)
+        if (options[index].arg_type == ARG_TYPE_NO_ARGUMENT)
         {
-            if (options[index].arg_type == ARG_TYPE_NO_ARGUMENT)
+            /* Sanity check that the option type is a flag or function pointer */
+            if (options[index].option_type != OPTION_TYPE_FLAG && options[index].option_type != OPTION_TYPE_FUNC_PTR)
             {
-                /* Sanity check that the option type is a flag or function pointer */
-                if (options[index].option_type != OPTION_TYPE_FLAG && options[index].option_type != OPTION_TYPE_FUNC_PTR)
-                {
-                    console_print_error(LOGGING_LEVEL_0, "%s: Fatal error! Option \"%s\" is not a OPTION_TYPE_FLAG or OPTION_TYPE_FUNC_PTR but was specified with ARG_TYPE_NO_ARGUMENT!", __FUNCTION__, options[index].name);
-                    exit(FR_ASSERT_FAIL);
-                }
+                console_print_error(LOGGING_LEVEL_0, "%s: Fatal error! Option \"%s\" is not a OPTION_TYPE_FLAG or OPTION_TYPE_FUNC_PTR but was specified with ARG_TYPE_NO_ARGUMENT!", __FUNCTION__, options[index].name);
+                exit(FR_ASSERT_FAIL);
             }
-            else if (options[index].arg_type == ARG_TYPE_NO_ARGUMENT)
+        }
+        else if (options[index].arg_type == ARG_TYPE_NO_ARGUMENT)
+        {
+            /* Sanity check that the option type is not a flag or function pointer */
+            if (options[index].option_type == OPTION_TYPE_FLAG || options[index].option_type == OPTION_TYPE_FUNC_PTR)
             {
-                /* Sanity check that the option type is not a flag or function pointer */
-                if (options[index].option_type == OPTION_TYPE_FLAG || options[index].option_type == OPTION_TYPE_FUNC_PTR)
-                {
-                    console_print_error(LOGGING_LEVEL_0, "%s: Fatal error! Option \"%s\" is a OPTION_TYPE_FLAG or OPTION_TYPE_FUNC_PTR but was specified with ARG_TYPE_REQUIRED_ARGUMENT!", __FUNCTION__, options[index].name);
-                    exit(FR_ASSERT_FAIL);
-                }
+                console_print_error(LOGGING_LEVEL_0, "%s: Fatal error! Option \"%s\" is a OPTION_TYPE_FLAG or OPTION_TYPE_FUNC_PTR but was specified with ARG_TYPE_REQUIRED_ARGUMENT!", __FUNCTION__, options[index].name);
+                exit(FR_ASSERT_FAIL);
             }
-            index++;
         }
+        index++;
+    }
 
-        /* If a function pointer was passed in, the user intends to link the options to an existing option that is of
-        the function pointer type. This allows one to link both option groups to display from a single help print option.*/
-        if (function)
-        {
-            console_print_debug(LOGGING_LEVEL_1, "%s: Looking for option with destination 0x%x", __FUNCTION__, function);
+    /* If a function pointer was passed in, the user intends to link the options to an existing option that is of
+    the function pointer type. This allows one to link both option groups to display from a single help print option.*/
+    if (function)
+    {
+        CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Looking for option with destination 0x%x", __FUNCTION__, function);
 
-            /* Iterate through existing registered option groups */
-            for (int i = 0; i < num_registered_options; i++)
+        /* Iterate through existing registered option groups */
+        for (int i = 0; i < num_registered_options; i++)
+        {
+            options = options_registry[i]->options;
+            index   = 0;
+            while (options[index].name)
             {
-                options = options_registry[i]->options;
-                index   = 0;
-                while (options[index].name)
+                /* Iterate through function group options */
+                if (options[index].option_type == OPTION_TYPE_FUNC_PTR &&
+                    options[index].destination == (void *)function)
                 {
-                    /* Iterate through function group options */
-                    if (options[index].option_type == OPTION_TYPE_FUNC_PTR &&
-                        options[index].destination == (void *)function)
-                    {
-                        /* Found a match, update the function_options member */
-                        options[index].function_options = option_group;
-                        function_option_registered      = true;
-                        parent_function_option          = &options[index];
-                        break;
-                    }
-                    index++;
+                    /* Found a match, update the function_options member */
+                    options[index].function_options = option_group;
+                    function_option_registered      = true;
+                    parent_function_option          = &options[index];
+                    break;
                 }
-            }
-            if (!function_option_registered)
-            {
-                console_print_error(LOGGING_LEVEL_0, "%s: Fatal error: couldn't find a matching function pointer for option registration!", __FUNCTION__);
-                fatal_error = true;
-            }
-            else
-            {
-                console_print_debug(LOGGING_LEVEL_1, "%s: Successfully registered options \"%s\" to function \"%s\"", __FUNCTION__, option_group->name, parent_function_option->name);
+                index++;
             }
         }
-        /* Options not tied to a function, add it to the main registry as another entry */
+        if (!function_option_registered)
+        {
+            console_print_error(LOGGING_LEVEL_0, "%s: Fatal error: couldn't find a matching function pointer for option registration!", __FUNCTION__);
+            fatal_error = true;
+        }
+        else if (!args_index_add_internal(option_group, ARGS_FUNCTION_GROUP))
+        {
+            console_print_error(LOGGING_LEVEL_0, "%s: Fatal error: couldn't index options \"%s\"!", __FUNCTION__, option_group->name);
+            fatal_error = true;
+        }
         else
         {
-            /* Don't register more than once */
-            bool options_registered = false;
-            for (int i = 0; i < num_registered_options; i++)
+            /* Keep the function option at hand so that parsing for the function finds its options directly */
+            bool function_registered = false;
+            for (int i = 0; i < num_registered_functions; i++)
             {
-                if (options_registry[i] == option_group)
+                if (function_options_registry[i] == parent_function_option)
                 {
-                    options_registered = true;
+                    function_registered = true;
                 }
             }
-            if (!options_registered)
+            if (!function_registered)
             {
-                options_registry[num_registered_options++] = option_group;
-                console_print_debug(LOGGING_LEVEL_1, "%s: Successfully registered options \"%s\" to options registry! Registry now has %d options registered.", __FUNCTION__, option_group->name, num_registered_options);
+                registry = args_registry_reserve_internal(function_options_registry, &function_options_registry_size, num_registered_functions + 1, sizeof(CliOptions_t *));
+                if (!registry)
+                {
+                    console_print_error(LOGGING_LEVEL_0, "%s: Fatal error: can't register any more function option groups!", __FUNCTION__);
+                    fatal_error = true;
+                }
+                else
+                {
+                    function_options_registry                             = (CliOptions_t **)registry;
+                    function_options_registry[num_registered_functions++] = parent_function_option;
+                }
             }
-            else
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Successfully registered options \"%s\" to function \"%s\"", __FUNCTION__, option_group->name, parent_function_option->name);
+        }
+    }
+    /* Options not tied to a function, add it to the main registry as another entry */
+    else
+    {
+        /* Don't register more than once */
+        bool options_registered = false;
+        for (int i = 0; i < num_registered_options; i++)
+        {
+            if (options_registry[i] == option_group)
             {
-                console_print_debug(LOGGING_LEVEL_1, "%s: Options \"%s\" was already in the registry. Nothing happened.", __FUNCTION__, option_group->name, num_registered_options);
+                options_registered = true;
             }
         }
+        if (options_registered)
+        {
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Options \"%s\" was already in the registry. Nothing happened.", __FUNCTION__, option_group->name, num_registered_options);
+        }
+        else if (!(registry = args_registry_reserve_internal(options_registry, &options_registry_size, num_registered_options + 1, sizeof(CliOptionGroup_t *))))
+        {
+            console_print_error(LOGGING_LEVEL_0, "%s: Fatal error: can't register any more option groups!", __FUNCTION__);
+            fatal_error = true;
+        }
+        else if (!args_index_add_internal(option_group, num_registered_options))
+        {
+            console_print_error(LOGGING_LEVEL_0, "%s: Fatal error: couldn't index options \"%s\"!", __FUNCTION__, option_group->name);
+            fatal_error = true;
+        }
+        else
+        {
+            options_registry                           = (CliOptionGroup_t **)registry;
+            options_registry[num_registered_options++] = option_group;
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Successfully registered options \"%s\" to options registry! Registry now has %d options registered.", __FUNCTION__, option_group->name, num_registered_options);
+        }
     }
 
     /* Exit after fatal errors */
@@ -836,22 +1143,24 @@ GetOptResult_e args_getopt_index(int argc, char *argv[], CliOptions_t *options,
     /* Go through arguments from where we left off */
     int dash_count = 0;
 
-    for (int arg_index = current_arg_index; arg_index < argc; arg_index++)
+    if (!args_ledger_reserve_internal(argc))
+    {
+        console_print_error(LOGGING_LEVEL_0, "%s: Fatal error! Can't keep track of %d arguments!", __FUNCTION__, argc);
+        return GETOPT_BAD_OPTION;
+    }
+
+    /* Skip the arguments we've already successfully parsed */
+    for (int arg_index = args_ledger_find_unset_internal(current_arg_index, argc); arg_index < argc; arg_index = args_ledger_find_unset_internal(arg_index + 1, argc))
     {
-        /* Skip if we've already successfully parsed this argument */
-        if (arg_ledger[arg_index])
-        {
-            continue;
-        }
 
-        console_print_debug(LOGGING_LEVEL_1, "%s: Parsing argument \"%s\"...", __FUNCTION__, argv[arg_index]);
+        CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Parsing argument \"%s\"...", __FUNCTION__, argv[arg_index]);
 
         /* Check if the argument is help */
         if ((strcmp(argv[arg_index], "--help") == 0) || (strcmp(argv[arg_index], "-help") == 0))
         {
             /* Help was requested */
-            console_print_debug(LOGGING_LEVEL_1, "%s: Help requested!", __FUNCTION__);
-            arg_ledger[arg_index] = true; /* Mark the help argument as parsed */
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Help requested!", __FUNCTION__);
+            args_ledger_set_internal(arg_index); /* Mark the help argument as parsed */
             return GETOPT_HELP;
         }
 
@@ -891,9 +1200,9 @@ GetOptResult_e args_getopt_index(int argc, char *argv[], CliOptions_t *options,
                     *option_index                    = options_index; /* Set the index */
                     *option_arg                      = NULL;          /* No argument for this option */
                     options[options_index].is_parsed = true;          /* Mark the option as parsed */
-                    arg_ledger[arg_index]            = true;          /* Mark the argument as parsed */
                     current_arg_index                = arg_index + 1; /* Move the current argument index so that we start parsing on the next one */
-                    console_print_debug(LOGGING_LEVEL_1, "%s: Found option \"%s\".", __FUNCTION__, options[options_index].name);
+                    args_ledger_set_internal(arg_index);              /* Mark the argument as parsed */
+                    CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found option \"%s\".", __FUNCTION__, options[options_index].name);
                     return GETOPT_OK;
                 }
                 /* Check if the option is a required argument */
@@ -909,10 +1218,10 @@ GetOptResult_e args_getopt_index(int argc, char *argv[], CliOptions_t *options,
                             *option_index                    = options_index;       /* Set the index */
                             *option_arg                      = argv[arg_index + 1]; /* Set the argument */
                             options[options_index].is_parsed = true;                /* Mark the option as parsed */
-                            arg_ledger[arg_index]            = true;                /* Mark the argument as parsed (recognized option) */
-                            arg_ledger[arg_index + 1]        = true;                /* Mark the argument as parsed (recognized argument) */
                             current_arg_index                = arg_index + 2;       /* Move the current argument index so that we start parsing on the next one */
-                            console_print_debug(LOGGING_LEVEL_1, "%s: Found option \"%s\" with required argument \"%s\"", __FUNCTION__, options[options_index].name, argv[arg_index + 1]);
+                            args_ledger_set_internal(arg_index);                    /* Mark the argument as parsed (recognized option) */
+                            args_ledger_set_internal(arg_index + 1);                /* Mark the argument as parsed (recognized argument) */
+                            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found option \"%s\" with required argument \"%s\"", __FUNCTION__, options[options_index].name, argv[arg_index + 1]);
                             return GETOPT_OK;
                         }
                     }
@@ -941,6 +1250,11 @@ GetOptResult_e args_getopt_index(int argc, char *argv[], CliOptions_t *options,
  *              proceeding an option, but without dashes. For example, to specify an argument for the option "--option",
  *              the command line argument would be "--option argument".
  *
+ *              The arguments are gone through once, each option being looked up in the option name index among the
+ *              registry's groups (and the function's group if one was passed in) that haven't been parsed yet. A
+ *              function pointer option marks the function to return. From there on only the groups registered before
+ *              its own keep taking options, the rest are left for parsing the function's options.
+ *
  * @param[in]   argc                The count of arguments
  * @param       argv                The arguments array
  * @param       function            If set, this function will parse options pointed to by options with
@@ -949,247 +1263,179 @@ GetOptResult_e args_getopt_index(int argc, char *argv[], CliOptions_t *options,
  */
 ConsoleFunctionPointer_t args_parse(int argc, char *argv[], ConsoleFunctionPointer_t function, bool enable_help)
 {
-    int                      option_index;
+    ArgsIndexEntry_t        *entry;
+    CliOptions_t            *option;
     char                    *option_argument;
-    int                      option_offset;
-    GetOptResult_e           get_opt_result;
+    int                      dash_count;
     ConsoleFunctionPointer_t function_pointer_argument = NULL;
     CliOptionGroup_t        *function_options_group    = NULL;
-    CliOptionGroup_t        *current_options_group     = NULL;
-    CliOptions_t            *current_options           = NULL;
+    int                      group_limit               = ARGS_FUNCTION_GROUP;
     bool                     fatal_error               = false;
     bool                     help_wanted               = false;
+    bool                     unknown_option            = false;
 
     /* Check if we have arguments to parse */
     if (!(argc > 1))
     {
-        console_print_warn(LOGGING_LEVEL_1, "%s: No arguments to parse!", __FUNCTION__);
+        CONSOLE_PRINT_WARN(LOGGING_LEVEL_1, "%s: No arguments to parse!", __FUNCTION__);
         return NULL;
     }
 
-    /* Check if we support the number of arguments */
-    if (argc > MAX_CLI_ARGS)
+    /* Make room to keep track of the arguments */
+    if (!args_ledger_reserve_internal(argc))
     {
-        console_print_error(LOGGING_LEVEL_0, "%s: Fatal error! Too many arguments to parse! (%d > %d)", __FUNCTION__, argc, MAX_CLI_ARGS);
+        console_print_error(LOGGING_LEVEL_0, "%s: Fatal error! Can't keep track of %d arguments!", __FUNCTION__, argc);
         return NULL;
     }
 
-    console_print_debug(LOGGING_LEVEL_1, "%s: Command line arguments detected, will try to parse them", __FUNCTION__);
+    CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Command line arguments detected, will try to parse them", __FUNCTION__);
 
-    /* If we were provided a function pointer, we must also parse those arguments. We parse it at the end of our list,
-    after the option registry option groups. */
-    int option_groups_to_parse = (function ? num_registered_options + 1 : num_registered_options);
-    for (int i = 0; i < option_groups_to_parse; i++)
+    /* If we were provided a function pointer, we must also parse its options, they're looked up after the registry's */
+    if (function)
     {
-        /* If we're also parsing a function's arguments, parse the function arguments if we're at the last item */
-        if (function && (i == num_registered_options))
+        for (int i = 0; i < num_registered_functions; i++)
         {
-            if (!function_options_group)
+            if (function_options_registry[i]->destination == (void *)function)
             {
-                console_print_warn(LOGGING_LEVEL_1, "%s: Function does not have options to parse.", __FUNCTION__);
+                CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found options \"%s\" for function \"%s\"", __FUNCTION__, function_options_registry[i]->function_options->name, function_options_registry[i]->name);
+                function_options_group = function_options_registry[i]->function_options;
                 break;
             }
-            else
-            {
-                current_options_group = function_options_group;
-                current_options       = function_options_group->options;
-            }
         }
-        else
+        if (!function_options_group)
         {
-            current_options_group = options_registry[i];
-            current_options       = options_registry[i]->options;
+            CONSOLE_PRINT_WARN(LOGGING_LEVEL_1, "%s: Function does not have options to parse.", __FUNCTION__);
         }
+    }
 
-        if (current_options_group)
+    /* Make sure we don't have any NULL pointers in the destinations of options we're about to parse. Groups that were
+    already parsed are left alone, we won't waste cycles parsing them again. */
+    for (int i = 0; i < num_registered_options; i++)
+    {
+        if (!args_check_all_parsed(options_registry[i]->options) && !args_check_pointers(options_registry[i]->options))
         {
-            console_print_debug(LOGGING_LEVEL_1, "%s: Parsing options group: \"%s\" [%d/%d]", __FUNCTION__, current_options_group->name, i + 1, option_groups_to_parse);
+            fatal_error = true;
         }
+    }
+    if (function_options_group && !args_check_all_parsed(function_options_group->options) && !args_check_pointers(function_options_group->options))
+    {
+        fatal_error = true;
+    }
+
+    /* Skip the arguments we've already successfully parsed */
+    for (int arg_index = args_ledger_find_unset_internal(1, argc); (arg_index < argc) && !fatal_error; arg_index = args_ledger_find_unset_internal(arg_index + 1, argc))
+    {
+
+        CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Parsing argument \"%s\"...", __FUNCTION__, argv[arg_index]);
 
-        /* If we're specifying a function pointer and we haven't found it yet, then we need to look for that pointer in our registry */
-        if (function && !function_options_group)
+        /* Check if the argument is help, past a function pointer it's left for the function's help */
+        if ((strcmp(argv[arg_index], "--help") == 0) || (strcmp(argv[arg_index], "-help") == 0))
         {
-            unsigned int index = 0;
-            while (current_options[index].name != 0)
+            if (!function_pointer_argument)
             {
-                if (current_options[index].destination == (void *)function)
-                {
-                    if (current_options[index].function_options)
-                    {
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found options \"%s\" for function \"%s\"", __FUNCTION__, current_options[index].function_options->name, current_options[index].name);
-                        function_options_group = current_options[index].function_options;
-                    }
-                    else
-                    {
-                        console_print_warn(LOGGING_LEVEL_1, "%s: Found function \"%s\" but it does not have options associated with it. ", __FUNCTION__, current_options[index].name);
-                    }
-                }
-                index++;
+                CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Help wanted! Help's on the way.", __FUNCTION__);
+                args_ledger_set_internal(arg_index); /* Mark the help argument as parsed */
+                help_wanted = true;
+                break;
             }
+            continue;
         }
 
-        /* Check if we've already parsed these options. We won't waste cycles parsing again if we did.*/
-        if (args_check_all_parsed(current_options))
+        /* We should always be pointing at an option, unless it's the argument of an option that isn't ours */
+        if (argv[arg_index][0] != '-')
         {
-            console_print_debug(LOGGING_LEVEL_1, "%s: Already parsed, moving on...", __FUNCTION__);
+            if (!unknown_option)
+            {
+                console_print_error(LOGGING_LEVEL_0, "%s: Fatal error! Stray argument \"%s\" found!", __FUNCTION__, argv[arg_index]);
+                fatal_error = true;
+            }
+            unknown_option = false;
             continue;
         }
+        dash_count = (argv[arg_index][1] == '-') ? 2 : 1;
 
-        /* Make sure we don't have any NULL pointers in our option destinations */
-        if (!args_check_pointers(current_options))
+        /* Find the option, leaving it alone if it isn't ours */
+        entry          = args_index_resolve_internal(argv[arg_index] + dash_count, function_options_group, group_limit, !function_pointer_argument);
+        unknown_option = (entry == NULL);
+        if (!entry)
         {
-            fatal_error = true;
-            break;
+            continue;
         }
+        option = entry->option;
 
-        /* Reset the current argument index */
-        current_arg_index = 1;
-
-        while (1)
+        /* Get the option's argument if it requires one, making sure the next argument is not an option */
+        option_argument = NULL;
+        if (option->arg_type == ARG_TYPE_REQUIRED_ARGUMENT)
         {
-            option_index    = 0;
-            option_argument = NULL;
-            get_opt_result  = args_getopt_index(argc, argv, current_options, &option_index, &option_argument);
-
-            /* Check if we're done parsing */
-            if (get_opt_result == GETOPT_END)
-            {
-                console_print_debug(LOGGING_LEVEL_1, "%s: Reached end of current_options!", __FUNCTION__);
-                break;
-            }
-            else if (get_opt_result == GETOPT_HELP)
-            {
-                help_wanted = true;
-                console_print_debug(LOGGING_LEVEL_1, "%s: Help wanted! Help's on the way.", __FUNCTION__);
-                break;
-            }
-            /* If we got a GETOPT_OK, then we have a valid option_index (and option_argument if applicable) */
-            else if (get_opt_result == GETOPT_OK)
-            {
-                OptionType_e option_type = current_options[option_index].option_type;
-                switch (option_type)
-                {
-                    case OPTION_TYPE_FLAG:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a flag argument %s", __FUNCTION__, current_options[option_index].name);
-                        (*((bool *)(current_options[option_index].destination))) = true;
-                        break;
-                    case OPTION_TYPE_STRING:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a string argument %s", __FUNCTION__, option_argument);
-                        strncpy((char *)(current_options[option_index].destination), option_argument, MAX_PARSED_STRING_LEN);
-                        break;
-                    case OPTION_TYPE_ENUM:
-                        // Copy integer, and add one. Enums always start with a null value,
-                        // so we offset by one to zero index the first item.
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found an enum argument %s", __FUNCTION__, option_argument);
-                        (*((int *)(current_options[option_index].destination))) = atoi(option_argument) + 1;
-                        break;
-                    case OPTION_TYPE_FLOAT:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a float argument %s", __FUNCTION__, option_argument);
-                        (*((int *)(current_options[option_index].destination))) = atof(option_argument);
-                        break;
-                    case OPTION_TYPE_INT:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a decimal int argument %s", __FUNCTION__, option_argument);
-                        (*((int *)(current_options[option_index].destination))) = atoi(option_argument);
-                        break;
-                    case OPTION_TYPE_UINT:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a decimal unsigned int argument %s", __FUNCTION__, option_argument);
-                        (*((unsigned int *)(current_options[option_index].destination))) = atoi(option_argument);
-                        break;
-                    case OPTION_TYPE_UINT32:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a decimal uint32 argument %s", __FUNCTION__, option_argument);
-                        (*((uint32_t *)(current_options[option_index].destination))) = (uint32_t)atoi(option_argument);
-                        break;
-                    case OPTION_TYPE_UINT64:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a decimal uint64 argument %s", __FUNCTION__, option_argument);
-                        (*((uint64_t *)(current_options[option_index].destination))) = (uint64_t)atoll(option_argument);
-                        break;
-                    case OPTION_TYPE_HEXUINT8:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a hexadecimal uint8 argument %s", __FUNCTION__, option_argument);
-                        (*((uint8_t *)(current_options[option_index].destination))) = strtoul(option_argument, NULL, 16);
-                        break;
-                    case OPTION_TYPE_HEXUINT16:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a hexadecimal uint16 argument %s", __FUNCTION__, option_argument);
-                        (*((uint16_t *)(current_options[option_index].destination))) = strtoul(option_argument, NULL, 16);
-                        break;
-                    case OPTION_TYPE_HEXUINT32:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a hexadecimal uint32 argument %s", __FUNCTION__, option_argument);
-                        (*((uint32_t *)(current_options[option_index].destination))) = strtoul(option_argument, NULL, 16);
-                        break;
-                    case OPTION_TYPE_HEXUINT64:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a hexadecimal uint64 argument %s", __FUNCTION__, option_argument);
-                        (*((uint64_t *)(current_options[option_index].destination))) = strtoul(option_argument, NULL, 16);
-                        break;
-                    case OPTION_TYPE_FUNC_PTR:
-                        console_print_debug(LOGGING_LEVEL_1, "%s: Found a function pointer", __FUNCTION__);
-                        function_pointer_argument = current_options[option_index].destination;
-                        break;
-                    case OPTION_TYPE_NONE:
-                    default:
-                        console_print_error(LOGGING_LEVEL_0, "%s: Unexpected argument type %d. Aborting.", __FUNCTION__, current_options[option_index].option_type);
-                        fatal_error = true;
-                        break;
-                }
-            }
-            else /* We didn't get a good result */
+            if ((arg_index + 1 >= argc) || (argv[arg_index + 1][0] == '-'))
             {
+                console_print_error(LOGGING_LEVEL_0, "%s: Error! Option \"%s\" requires an argument!", __FUNCTION__, option->name);
                 fatal_error = true;
                 break;
             }
+            option_argument = argv[arg_index + 1];
+            args_ledger_set_internal(arg_index + 1); /* Mark the argument as parsed (recognized argument) */
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found option \"%s\" with required argument \"%s\"", __FUNCTION__, option->name, option_argument);
+        }
+        args_ledger_set_internal(arg_index); /* Mark the argument as parsed (recognized option) */
+        option->is_parsed = true;            /* Mark the option as parsed */
 
-            if (!fatal_error)
-            {
-                /* Set the option as defined */
-                if (current_options[option_index].is_defined_ptr)
-                {
-
-                    *current_options[option_index].is_defined_ptr = true;
-                    console_print_debug(LOGGING_LEVEL_1, "%s: Option \"%s\" set as defined through its pointer @ 0x%p.", __FUNCTION__, current_options[option_index].name, current_options[option_index].is_defined_ptr);
-                }
-                else
-                {
-                    console_print_debug(LOGGING_LEVEL_1, "%s: Option \"%s\" does not have a defined flag variable associated! Cannot set to defined state.", __FUNCTION__, current_options[option_index].name);
-                }
-            }
-
-            /* If a function pointer was detected as an argument or help was requested, let's get out of here */
-            if (function_pointer_argument || help_wanted)
-            {
-                break;
-            }
+        if (option->option_type == OPTION_TYPE_FUNC_PTR)
+        {
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Found a function pointer", __FUNCTION__);
+            function_pointer_argument = (ConsoleFunctionPointer_t)option->destination;
+            group_limit               = entry->group_order;
+        }
+        else if (!args_store_value_internal(option, option_argument))
+        {
+            fatal_error = true;
+            break;
         }
 
-        /* Exit after fatal errors */
-        if (fatal_error)
+        /* Set the option as defined */
+        if (option->is_defined_ptr)
+        {
+            *option->is_defined_ptr = true;
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Option \"%s\" set as defined through its pointer @ 0x%p.", __FUNCTION__, option->name, option->is_defined_ptr);
+        }
+        else
         {
-            exit(1);
+            CONSOLE_PRINT_DEBUG(LOGGING_LEVEL_1, "%s: Option \"%s\" does not have a defined flag variable associated! Cannot set to defined state.", __FUNCTION__, option->name);
         }
+    }
 
-        /*** Iteration enablement ***/
-        /* Keep track of these options as the latest ones to have been parsed */
-        last_options_parsed = current_options;
-        /* Set all options as parsed so that we don't repeat. For command line
-         * options, we assume that all options are parsed as optional parameters
-         * with default values are assumed when not being passed in. */
-        args_set_all_parsed(current_options, true);
+    /* Exit after fatal errors */
+    if (fatal_error)
+    {
+        exit(1);
+    }
 
-        /* Continuation of function pointer argument and help detection */
-        if (function_pointer_argument || help_wanted)
+    /*** Iteration enablement ***/
+    /* Set all options we went through as parsed so that we don't repeat, keeping track of the latest ones to have been
+     * parsed. For command line options, we assume that all options are parsed as optional parameters with default
+     * values are assumed when not being passed in. */
+    for (int i = 0; (i < num_registered_options) && (i <= group_limit); i++)
+    {
+        if (!args_check_all_parsed(options_registry[i]->options))
         {
-            break;
+            last_options_parsed = options_registry[i]->options;
+            args_set_all_parsed(options_registry[i]->options, true);
         }
     }
+    if (function_options_group && !args_check_all_parsed(function_options_group->options))
+    {
+        last_options_parsed = function_options_group->options;
+        args_set_all_parsed(function_options_group->options, true);
+    }
 
     /* If we have help enabled and we don't have a function pointer arg, we are at the terminal option parsing. Make
     sure that all options were recognized. */
     if (enable_help && !function_pointer_argument)
     {
-        for (int argv_index = 1; argv_index < argc; argv_index++)
+        for (int argv_index = args_ledger_find_unset_internal(1, argc); argv_index < argc; argv_index = args_ledger_find_unset_internal(argv_index + 1, argc))
         {
-            if (!arg_ledger[argv_index])
-            {
-                console_print_error(LOGGING_LEVEL_0, "%s: Fatal error: \"%s\" is not a recognized option!", __FUNCTION__, argv[argv_index]);
-                help_wanted = true;
-            }
+            console_print_error(LOGGING_LEVEL_0, "%s: Fatal error: \"%s\" is not a recognized option!", __FUNCTION__, argv[argv_index]);
+            help_wanted = true;
         }
     }
 
@@ -28,13 +28,11 @@
 #include "console.h"
 
 /* Help string dimensions */
-#define MAX_OPT_NAME_LENGTH (25)  ///< Maximum length of option name field
-#define MAX_OPT_ARGS_LENGTH (5)   ///< Maximum length of argument type field
-#define MAX_OPT_DESC_LENGTH (70)  ///< Maximum length of option description field
-#define OPT_DBL_DASH_OFFSET (2)   ///< Offset for '--' prepending options
-#define OPT_SGL_DASH_OFFSET (1)   ///< Offset for '-' prepending options
-#define MAX_OPTION_GROUPS   (10)  ///< Maximum number of option groups in the options registry
-#define MAX_CLI_ARGS        (128) ///< Maximum number of CLI arguments
+#define MAX_OPT_NAME_LENGTH (25) ///< Maximum length of option name field
+#define MAX_OPT_ARGS_LENGTH (5)  ///< Maximum length of argument type field
+#define MAX_OPT_DESC_LENGTH (70) ///< Maximum length of option description field
+#define OPT_DBL_DASH_OFFSET (2)  ///< Offset for '--' prepending options
+#define OPT_SGL_DASH_OFFSET (1)  ///< Offset for '-' prepending options
 
 #define MAX_PARSED_STRING_LEN        (1023)                      ///< Maximum number of characters we can parse from an OPTION_TYPE_STRING
 #define MAX_PARSED_STRING_BUFFER_LEN (MAX_PARSED_STRING_LEN + 1) ///< Maximum buffer size for OPTION_TYPE_STRING
@@ -50,6 +48,9 @@
         0, 0, 0, 0, 0, 0, 0, 0 \
     }
 
+/* An option's value as an lvalue of the given type, for options looked up once with args_get_option() */
+#define ARGS_OPTION_VALUE(option, type) (*((type *)((option)->destination)))
+
 /**
  * @brief Result of the args_getopt_index() function.
  *
@@ -141,15 +142,16 @@ void args_set_u_int16_value(const char *name, CliOptions_t *options, uint16_t va
 void args_set_u_int32_value(const char *name, CliOptions_t *options, uint32_t value);
 void args_set_u_int64_value(const char *name, CliOptions_t *options, uint64_t value);
 
-void       *args_get_option_destination_pointer(const char *name, CliOptions_t *options);
-int         args_get_flag_value(const char *name, CliOptions_t *options);
-const char *args_get_string_value(const char *name, CliOptions_t *options);
-int         args_get_enum_value(const char *name, CliOptions_t *options);
-int         args_get_int_value(const char *name, CliOptions_t *options);
-uint8_t     args_get_u_int8_value(const char *name, CliOptions_t *options);
-uint16_t    args_get_u_int16_value(const char *name, CliOptions_t *options);
-uint32_t    args_get_u_int32_value(const char *name, CliOptions_t *options);
-uint64_t    args_get_u_int64_value(const char *name, CliOptions_t *options);
+CliOptions_t *args_get_option(const char *name, CliOptions_t *options);
+void         *args_get_option_destination_pointer(const char *name, CliOptions_t *options);
+int           args_get_flag_value(const char *name, CliOptions_t *options);
+const char   *args_get_string_value(const char *name, CliOptions_t *options);
+int           args_get_enum_value(const char *name, CliOptions_t *options);
+int           args_get_int_value(const char *name, CliOptions_t *options);
+uint8_t       args_get_u_int8_value(const char *name, CliOptions_t *options);
+uint16_t      args_get_u_int16_value(const char *name, CliOptions_t *options);
+uint32_t      args_get_u_int32_value(const char *name, CliOptions_t *options);
+uint64_t      args_get_u_int64_value(const char *name, CliOptions_t *options);
 
 void args_set_last_option_parsed(bool state);
 void args_set_all_parsed(CliOptions_t *options, bool state);
@@ -0,0 +1,170 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Argument parser benchmark, registers 10 groups of 200 options and parses a command line of 1,000 arguments (500
+ * options with their values) spread over all of them. The parser keeps track of arguments for the life of the
+ * process, so every run happens in a child process of its own.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "args.h"
+#include "console.h"
+
+#define NUM_GROUPS        (10)
+#define OPTIONS_PER_GROUP (200)
+#define NUM_ARGUMENTS     (1000)
+#define NUM_RUNS          (20)
+
+static int              values[NUM_GROUPS][OPTIONS_PER_GROUP];
+static char             names[NUM_GROUPS][OPTIONS_PER_GROUP][16];
+static CliOptions_t     options[NUM_GROUPS][OPTIONS_PER_GROUP + 1];
+static CliOptionGroup_t groups[NUM_GROUPS];
+static char             arguments[NUM_ARGUMENTS / 2][16];
+static char            *argv[NUM_ARGUMENTS + 1];
+
+static void bench_sink(const char *data, size_t length)
+{
+    (void)data;
+    (void)length;
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+    double difference = *(const double *)a - *(const double *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+/* One run: register everything, parse once and report both times */
+static void bench_run(int result_fd)
+{
+    ConsoleSettings_t settings = {
+        .logging_level = LOGGING_LEVEL_0,
+        .write_fn      = bench_sink,
+    };
+    double times[2];
+    double start;
+    long   sum = 0;
+
+    console_init(&settings);
+
+    start = bench_now();
+    for (int g = 0; g < NUM_GROUPS; g++)
+    {
+        args_register_options(&groups[g], NULL);
+    }
+    times[0] = bench_now() - start;
+
+    start = bench_now();
+    args_parse(NUM_ARGUMENTS + 1, argv, NULL, true);
+    times[1] = bench_now() - start;
+
+    /* Every option on the command line sets its value to its own index */
+    for (int g = 0; g < NUM_GROUPS; g++)
+    {
+        for (int o = 0; o < OPTIONS_PER_GROUP; o++)
+        {
+            sum += values[g][o];
+        }
+    }
+    if ((sum == 0) || (write(result_fd, times, sizeof(times)) != sizeof(times)))
+    {
+        _exit(1);
+    }
+    _exit(0);
+}
+
+int main(void)
+{
+    double registration[NUM_RUNS];
+    double parsing[NUM_RUNS];
+    int    results[2];
+
+    for (int g = 0; g < NUM_GROUPS; g++)
+    {
+        for (int o = 0; o < OPTIONS_PER_GROUP; o++)
+        {
+            snprintf(names[g][o], sizeof(names[g][o]), "g%do%d", g, o);
+            options[g][o] = (CliOptions_t){names[g][o], "Benchmark option", ARG_TYPE_REQUIRED_ARGUMENT, OPTION_TYPE_INT, &values[g][o], false, NULL, NULL};
+        }
+        options[g][OPTIONS_PER_GROUP] = (CliOptions_t){0};
+        groups[g]                     = (CliOptionGroup_t){"Benchmark group", NULL, options[g]};
+    }
+
+    /* Options from every group in turn, each used once */
+    argv[0] = "bench_args_parse";
+    for (int i = 0; i < NUM_ARGUMENTS / 2; i++)
+    {
+        snprintf(arguments[i], sizeof(arguments[i]), "--g%do%d", i % NUM_GROUPS, (i / NUM_GROUPS) * 3);
+        argv[1 + 2 * i] = arguments[i];
+        argv[2 + 2 * i] = "1";
+    }
+
+    if (pipe(results) != 0)
+    {
+        return 1;
+    }
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        double times[2];
+        int    status;
+        pid_t  child = fork();
+
+        if (child == 0)
+        {
+            bench_run(results[1]);
+        }
+        if ((waitpid(child, &status, 0) != child) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0) ||
+            (read(results[0], times, sizeof(times)) != sizeof(times)))
+        {
+            printf("Run %d failed\n", run);
+            return 1;
+        }
+        registration[run] = times[0];
+        parsing[run]      = times[1];
+    }
+
+    qsort(registration, NUM_RUNS, sizeof(double), bench_compare);
+    qsort(parsing, NUM_RUNS, sizeof(double), bench_compare);
+    printf("%d groups x %d options, %d arguments, %d runs\n", NUM_GROUPS, OPTIONS_PER_GROUP, NUM_ARGUMENTS, NUM_RUNS);
+    printf("%-13s %10s %10s\n", "", "min us", "median us");
+    printf("%-13s %10.1f %10.1f\n", "registration", registration[0] * 1e6, registration[NUM_RUNS / 2] * 1e6);
+    printf("%-13s %10.1f %10.1f\n", "parse", parsing[0] * 1e6, parsing[NUM_RUNS / 2] * 1e6);
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Input latency benchmark, measures the time from a key arriving on a terminal to the program having read it. The
+ * built-in termios backend (console_posix_get_char()) is compared with the way keys used to be read: running
+ * "/bin/stty raw" before and "/bin/stty cooked" after every key. A pseudo terminal stands in for the user's terminal,
+ * a child process reads the keys from it and acknowledges each one over a pipe.
+ */
+
+#define _XOPEN_SOURCE 600
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "console.h"
+
+#define TERMIOS_KEYS (2000)
+#define STTY_KEYS    (200)
+
+typedef enum BenchBackend
+{
+    BENCH_TERMIOS,
+    BENCH_STTY,
+} BenchBackend_e;
+
+static double bench_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+    double difference = *(const double *)a - *(const double *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+/* The child's side: read keys from the terminal on stdin and acknowledge each one */
+static void bench_reader(BenchBackend_e backend, const char *terminal, int ack_fd, unsigned int num_keys)
+{
+    int fd;
+
+    setsid();
+    fd = open(terminal, O_RDWR);
+    if (fd < 0)
+    {
+        _exit(1);
+    }
+    dup2(fd, STDIN_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    if (backend == BENCH_TERMIOS)
+    {
+        console_posix_input_init();
+    }
+    setvbuf(stdin, NULL, _IONBF, 0);
+
+    for (unsigned int i = 0; i < num_keys; i++)
+    {
+        char key;
+
+        if (backend == BENCH_TERMIOS)
+        {
+            key = console_posix_get_char();
+        }
+        else
+        {
+            if (system("/bin/stty raw") != 0)
+            {
+                _exit(1);
+            }
+            key = (char)getchar();
+            if (system("/bin/stty cooked") != 0)
+            {
+                _exit(1);
+            }
+        }
+        if (write(ack_fd, &key, 1) != 1)
+        {
+            _exit(1);
+        }
+    }
+
+    _exit(0);
+}
+
+static void bench_run(const char *name, BenchBackend_e backend, unsigned int num_keys)
+{
+    int     master = posix_openpt(O_RDWR | O_NOCTTY);
+    int     ack[2];
+    pid_t   child;
+    double *latencies = (double *)malloc(sizeof(double) * num_keys);
+    double  total     = 0.0;
+    int     status;
+
+    if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0) || (pipe(ack) != 0) || !latencies)
+    {
+        printf("%-8s could not set up a pseudo terminal\n", name);
+        exit(1);
+    }
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    child = fork();
+    if (child == 0)
+    {
+        close(ack[0]);
+        bench_reader(backend, ptsname(master), ack[1], num_keys);
+    }
+    close(ack[1]);
+
+    /* Let the reader get settled before the first key */
+    usleep(100000);
+
+    for (unsigned int i = 0; i < num_keys; i++)
+    {
+        char   discard[256];
+        char   key = 'a' + (char)(i % 26);
+        char   echo;
+        double start;
+
+        start = bench_now();
+        if ((write(master, &key, 1) != 1) || (read(ack[0], &echo, 1) != 1) || (echo != key))
+        {
+            printf("%-8s lost key %u\n", name, i);
+            exit(1);
+        }
+        latencies[i] = bench_now() - start;
+        total += latencies[i];
+
+        /* Whatever the terminal echoed back, so it never fills up */
+        while (read(master, discard, sizeof(discard)) > 0)
+        {
+        }
+    }
+
+    waitpid(child, &status, 0);
+    close(ack[0]);
+    close(master);
+
+    qsort(latencies, num_keys, sizeof(double), bench_compare);
+    printf("%-8s %6u %10.1f %10.1f %10.1f\n", name, num_keys, total / num_keys * 1e6, latencies[num_keys / 2] * 1e6,
+           latencies[num_keys * 99 / 100] * 1e6);
+    free(latencies);
+}
+
+int main(void)
+{
+    printf("%-8s %6s %10s %10s %10s\n", "backend", "keys", "mean us", "p50 us", "p99 us");
+    bench_run("termios", BENCH_TERMIOS, TERMIOS_KEYS);
+    if (access("/bin/stty", X_OK) == 0)
+    {
+        bench_run("stty", BENCH_STTY, STTY_KEYS);
+    }
+    else
+    {
+        printf("%-8s skipped, /bin/stty not found\n", "stty");
+    }
+
+    return 0;
+}
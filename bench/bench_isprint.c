@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Printable length scanner benchmark, compares console_isprint_str_len() against the original byte at a time
+ * implementation on long colored strings and on short, terminal width ones. Only SGR ("m") sequences are used so that
+ * both implementations agree on the result.
+ */
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "console.h"
+
+#define LONG_LENGTH  (64 * 1024)
+#define SHORT_LENGTH (80)
+#define TOTAL_BYTES  (256ull * 1024 * 1024)
+
+/* The implementation console_isprint_str_len() replaced */
+static size_t bench_isprint_str_len_old(const char *str)
+{
+    size_t len                = 0;
+    bool   inside_escape_code = false;
+
+    while (*str)
+    {
+        unsigned char c = *str;
+        if (c == '\x1b')
+        {
+            inside_escape_code = true;
+        }
+        else if (inside_escape_code && ((c == 'm') || (c == 'J')))
+        {
+            inside_escape_code = false;
+        }
+        else if (!inside_escape_code && isprint(c))
+        {
+            ++len;
+        }
+        ++str;
+    }
+
+    return len;
+}
+
+/* Words of text, every few of them colored */
+static void bench_colored_string(char *str, size_t length)
+{
+    static const char *const colors[] = {ANSI_COLOR_RED, ANSI_COLOR_GREEN, ANSI_COLOR_YELLOW, ANSI_COLOR_BLUE, ANSI_COLOR_RESET};
+    size_t                   used     = 0;
+
+    srand(1);
+    while (used + 16 < length)
+    {
+        if ((rand() % 4) == 0)
+        {
+            const char *color = colors[(size_t)rand() % (sizeof(colors) / sizeof(colors[0]))];
+            memcpy(&str[used], color, strlen(color));
+            used += strlen(color);
+        }
+        for (int i = 3 + rand() % 8; i > 0; i--)
+        {
+            str[used++] = (char)('a' + rand() % 26);
+        }
+        str[used++] = ' ';
+    }
+    str[used] = '\0';
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void bench_run(const char *name, const char *str)
+{
+    size_t          length     = strlen(str);
+    size_t          iterations = TOTAL_BYTES / length;
+    volatile size_t sink       = 0;
+    double          start;
+    double          old_time;
+    double          new_time;
+
+    if (bench_isprint_str_len_old(str) != console_isprint_str_len(str))
+    {
+        printf("%s: implementations disagree (%zu vs %zu)\n", name, bench_isprint_str_len_old(str), console_isprint_str_len(str));
+        exit(1);
+    }
+
+    start = bench_now();
+    for (size_t i = 0; i < iterations; i++)
+    {
+        sink += bench_isprint_str_len_old(str);
+    }
+    old_time = bench_now() - start;
+
+    start = bench_now();
+    for (size_t i = 0; i < iterations; i++)
+    {
+        sink += console_isprint_str_len(str);
+    }
+    new_time = bench_now() - start;
+
+    printf("%-8s %8zu %12.1f %12.1f %8.2fx\n", name, length, (double)length * iterations / old_time / 1e6, (double)length * iterations / new_time / 1e6,
+           old_time / new_time);
+}
+
+int main(void)
+{
+    static char long_string[LONG_LENGTH];
+    static char short_string[SHORT_LENGTH];
+
+    bench_colored_string(long_string, sizeof(long_string));
+    bench_colored_string(short_string, sizeof(short_string));
+
+    printf("%-8s %8s %12s %12s %9s\n", "string", "bytes", "old MB/s", "new MB/s", "speedup");
+    bench_run("long", long_string);
+    bench_run("short", short_string);
+
+    return 0;
+}
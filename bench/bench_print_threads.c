@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Multi-threaded print benchmark, measures how console_print throughput scales with the number of printing threads.
+ * Output goes to a sink that only counts bytes so that the terminal isn't what's being measured.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "console.h"
+
+#define MAX_THREADS       (8)
+#define LINES_PER_THREAD  (200000)
+
+static atomic_size_t sink_bytes = 0;
+
+static void bench_sink(const char *data, size_t length)
+{
+    (void)data;
+    atomic_fetch_add_explicit(&sink_bytes, length, memory_order_relaxed);
+}
+
+static void *bench_worker(void *arg)
+{
+    unsigned int thread = (unsigned int)(size_t)arg;
+
+    for (unsigned int line = 0; line < LINES_PER_THREAD; line++)
+    {
+        console_print(LOGGING_LEVEL_0, "worker %u line %u value 0x%08x status %s", thread, line, line * 2654435761u, "ok");
+    }
+
+    return NULL;
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+int main(void)
+{
+    ConsoleSettings_t settings = {
+        .logging_level = LOGGING_LEVEL_0,
+        .write_fn      = bench_sink,
+    };
+    double single_rate = 0.0;
+
+    console_init(&settings);
+    printf("%-8s %14s %14s %8s\n", "threads", "lines/s", "MB/s", "scaling");
+    for (size_t num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2)
+    {
+        pthread_t threads[MAX_THREADS];
+        double    start;
+        double    elapsed;
+        double    rate;
+
+        atomic_store(&sink_bytes, 0);
+        start = bench_now();
+        for (size_t i = 0; i < num_threads; i++)
+        {
+            pthread_create(&threads[i], NULL, bench_worker, (void *)i);
+        }
+        for (size_t i = 0; i < num_threads; i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        elapsed = bench_now() - start;
+        rate    = (double)(num_threads * LINES_PER_THREAD) / elapsed;
+        if (num_threads == 1)
+        {
+            single_rate = rate;
+        }
+        printf("%-8zu %14.0f %14.1f %7.2fx\n", num_threads, rate, (double)atomic_load(&sink_bytes) / elapsed / 1e6, rate / single_rate);
+    }
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Table rendering benchmark, prints a 10,000 row by 10 column table (100k cells) with console_print_table() and again
+ * with console_print_table_stream(). Output goes to a sink that only counts bytes so that the terminal isn't what's
+ * being measured.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "console.h"
+
+#define NUM_ROWS    (10000)
+#define NUM_COLUMNS (10)
+#define NUM_RUNS    (5)
+
+static size_t   sink_bytes = 0;
+static char    *names[NUM_ROWS];
+static uint32_t counts[NUM_ROWS];
+static int32_t  deltas[NUM_ROWS];
+static uint64_t totals[NUM_ROWS];
+static float    ratios[NUM_ROWS];
+static uint32_t addresses[NUM_ROWS];
+static uint16_t flags[NUM_ROWS];
+static bool     enabled[NUM_ROWS];
+static uint8_t  levels[NUM_ROWS];
+static char     grades[NUM_ROWS];
+
+static const TypeEnum_e column_types[NUM_COLUMNS] = {TYPE_STRING,  TYPE_DEC_UINT32, TYPE_DEC_INT32,  TYPE_DEC_UINT64, TYPE_FLOAT,
+                                                     TYPE_HEX_INT32, TYPE_HEX_INT16, TYPE_BOOL_WORD, TYPE_DEC_UINT8, TYPE_CHAR};
+static const char      *column_headers[NUM_COLUMNS] = {"Name", "Count", "Delta", "Total", "Ratio", "Address", "Flags", "Enabled", "Level", "Grade"};
+static void            *column_values[NUM_COLUMNS]  = {names, counts, deltas, totals, ratios, addresses, flags, enabled, levels, grades};
+
+static void bench_sink(const char *data, size_t length)
+{
+    (void)data;
+    sink_bytes += length;
+}
+
+static bool bench_fetch_row(void *context, unsigned long row, void *values[], TableCellOptions_t options[])
+{
+    (void)context;
+    (void)options;
+
+    if (row >= NUM_ROWS)
+    {
+        return false;
+    }
+    values[0] = &names[row];
+    values[1] = &counts[row];
+    values[2] = &deltas[row];
+    values[3] = &totals[row];
+    values[4] = &ratios[row];
+    values[5] = &addresses[row];
+    values[6] = &flags[row];
+    values[7] = &enabled[row];
+    values[8] = &levels[row];
+    values[9] = &grades[row];
+
+    return true;
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void bench_report(const char *name, double elapsed, size_t bytes)
+{
+    printf("%-8s %10.2f ms %14.0f cells/s %10.1f MB/s\n", name, elapsed * 1e3 / NUM_RUNS, (double)NUM_ROWS * NUM_COLUMNS * NUM_RUNS / elapsed,
+           (double)bytes / elapsed / 1e6);
+}
+
+int main(void)
+{
+    ConsoleSettings_t settings = {
+        .logging_level = LOGGING_LEVEL_0,
+        .write_fn      = bench_sink,
+    };
+    TableColumn_t       columns[NUM_COLUMNS];
+    TableStreamColumn_t stream_columns[NUM_COLUMNS];
+    TableStream_t       stream = {
+              .columns         = stream_columns,
+              .num_columns     = NUM_COLUMNS,
+              .fetch_row       = bench_fetch_row,
+              .sample_rows     = 64,
+              .overflow_policy = TABLE_OVERFLOW_TRUNCATE,
+    };
+    double start;
+
+    for (unsigned int row = 0; row < NUM_ROWS; row++)
+    {
+        names[row] = malloc(32);
+        snprintf(names[row], 32, "entry-%u", row * 7919u);
+        counts[row]    = row * 2654435761u;
+        deltas[row]    = (int32_t)(row * 40503u) - 1000000;
+        totals[row]    = (uint64_t)row * 0x9e3779b97f4a7c15ull;
+        ratios[row]    = (float)row / 7.0f;
+        addresses[row] = 0x20000000u + row * 4u;
+        flags[row]     = (uint16_t)(row ^ 0x5a5a);
+        enabled[row]   = (row % 3) == 0;
+        levels[row]    = (uint8_t)row;
+        grades[row]    = (char)('A' + (row % 5));
+    }
+    for (int i = 0; i < NUM_COLUMNS; i++)
+    {
+        columns[i]        = (TableColumn_t){.header = column_headers[i], .values = column_values[i], .type = column_types[i], .options = NULL};
+        stream_columns[i] = (TableStreamColumn_t){.header = column_headers[i], .type = column_types[i], .width = 0};
+    }
+
+    console_init(&settings);
+    printf("%d rows x %d columns, average of %d runs\n", NUM_ROWS, NUM_COLUMNS, NUM_RUNS);
+
+    sink_bytes = 0;
+    start      = bench_now();
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        console_print_table(LOGGING_LEVEL_0, NUM_ROWS, NUM_COLUMNS, &columns[0], &columns[1], &columns[2], &columns[3], &columns[4],
+                            &columns[5], &columns[6], &columns[7], &columns[8], &columns[9]);
+        console_flush();
+    }
+    bench_report("table", bench_now() - start, sink_bytes);
+
+    sink_bytes = 0;
+    start      = bench_now();
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        console_print_table_stream(LOGGING_LEVEL_0, &stream);
+        console_flush();
+    }
+    bench_report("stream", bench_now() - start, sink_bytes);
+
+    for (unsigned int row = 0; row < NUM_ROWS; row++)
+    {
+        free(names[row]);
+    }
+
+    return 0;
+}
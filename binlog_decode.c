@@ -0,0 +1,163 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "console.h"
+
+// Offline decoder for binary log dumps written by console_binlog_dump(). Usage:
+//   umami-binlog-decode <dump file>
+
+int main(int argc, char *argv[])
+{
+    FILE    *file;
+    char     magic[4];
+    uint32_t version;
+    char   **formats     = NULL;
+    uint32_t num_formats = 0;
+    int      tag;
+    bool     corrupt     = false;
+    char     buffer[STRING_BUFFER_SIZE];
+    uint8_t  args[BINLOG_ARGS_SIZE];
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s <dump file>\n", argv[0]);
+        return FR_INVALID;
+    }
+
+    file = fopen(argv[1], "rb");
+    if (!file)
+    {
+        fprintf(stderr, "%s: Could not open \"%s\"!\n", argv[0], argv[1]);
+        return FR_NOTFOUND;
+    }
+
+    if ((fread(magic, 1, sizeof(magic), file) != sizeof(magic)) || (memcmp(magic, BINLOG_FILE_MAGIC, sizeof(magic)) != 0) ||
+        (fread(&version, sizeof(version), 1, file) != 1) || (version != BINLOG_FILE_VERSION))
+    {
+        fprintf(stderr, "%s: \"%s\" is not a binary log dump!\n", argv[0], argv[1]);
+        fclose(file);
+        return FR_INVALID;
+    }
+
+    while ((tag = fgetc(file)) != EOF)
+    {
+        uint32_t format_id;
+
+        /* Every dump appended to the file starts a new section with its own format strings */
+        if (tag == BINLOG_FILE_MAGIC[0])
+        {
+            if ((fread(magic, 1, sizeof(magic) - 1, file) != sizeof(magic) - 1) ||
+                (memcmp(magic, &BINLOG_FILE_MAGIC[1], sizeof(magic) - 1) != 0) || (fread(&version, sizeof(version), 1, file) != 1) ||
+                (version != BINLOG_FILE_VERSION))
+            {
+                corrupt = true;
+                break;
+            }
+            while (num_formats)
+            {
+                free(formats[--num_formats]);
+            }
+            continue;
+        }
+
+        if (fread(&format_id, sizeof(format_id), 1, file) != 1)
+        {
+            corrupt = true;
+            break;
+        }
+
+        if (tag == BINLOG_FILE_TAG_FORMAT)
+        {
+            uint16_t format_length;
+            char    *format;
+            char   **new_formats;
+
+            if ((fread(&format_length, sizeof(format_length), 1, file) != 1) || (format_id != num_formats))
+            {
+                corrupt = true;
+                break;
+            }
+            new_formats = (char **)realloc(formats, sizeof(char *) * (num_formats + 1));
+            if (!new_formats)
+            {
+                fprintf(stderr, "%s: Out of memory!\n", argv[0]);
+                corrupt = true;
+                break;
+            }
+            formats = new_formats;
+            format  = (char *)malloc(format_length + 1);
+            if (!format || (fread(format, 1, format_length, file) != format_length))
+            {
+                free(format);
+                corrupt = true;
+                break;
+            }
+            format[format_length]  = '\0';
+            formats[num_formats++] = format;
+        }
+        else if (tag == BINLOG_FILE_TAG_RECORD)
+        {
+            uint64_t timestamp;
+            int8_t   logging_level;
+            uint16_t args_size;
+
+            if ((fread(&timestamp, sizeof(timestamp), 1, file) != 1) || (fread(&logging_level, sizeof(logging_level), 1, file) != 1) ||
+                (fread(&args_size, sizeof(args_size), 1, file) != 1) || (args_size > sizeof(args)) ||
+                (fread(args, 1, args_size, file) != args_size) || (format_id >= num_formats))
+            {
+                corrupt = true;
+                break;
+            }
+            console_binlog_format(buffer, sizeof(buffer), formats[format_id], args, args_size);
+            printf("[%" PRIu64 ".%09" PRIu64 "] L%d %s\n", (uint64_t)(timestamp / 1000000000ull), (uint64_t)(timestamp % 1000000000ull),
+                   logging_level, buffer);
+        }
+        else
+        {
+            corrupt = true;
+            break;
+        }
+    }
+
+    if (corrupt || ferror(file))
+    {
+        fprintf(stderr, "%s: \"%s\" is truncated or corrupt!\n", argv[0], argv[1]);
+        corrupt = true;
+    }
+
+    for (uint32_t i = 0; i < num_formats; i++)
+    {
+        free(formats[i]);
+    }
+    free(formats);
+
+    fclose(file);
+    return corrupt ? FR_FAIL : FR_OK;
+}
@@ -25,14 +25,171 @@
 #include <ctype.h>
 #include <inttypes.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define CONSOLE_SIMD_SSE2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CONSOLE_SIMD_AVX2
+#endif
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#define CONSOLE_ASYNC_SUPPORTED
+#define CONSOLE_POSIX_INPUT_SUPPORTED
+#endif
 
 #include "console.h"
 
-/* Provide a default console settings struct */
+#if defined(_MSC_VER)
+#define CONSOLE_THREAD_LOCAL __declspec(thread)
+#else
+#define CONSOLE_THREAD_LOCAL _Thread_local
+#endif
+
+/* A single record of the asynchronous logging queue, sequence numbers follow Vyukov's bounded queue. A message takes
+ * up a run of consecutive records, the first of which holds the number of records in the run. */
+typedef struct ConsoleAsyncRecord
+{
+    atomic_size_t sequence;
+    atomic_size_t num_records; /* First record of a message only */
+    size_t        length;
+    char          data[ASYNC_RECORD_SIZE];
+} ConsoleAsyncRecord_t;
+
+#define BINLOG_MAX_ARGS              (16) ///< Maximum number of arguments captured from a single binary log call
+#define BINLOG_SIGNATURE_CACHE_SIZE  (64) ///< Number of per-thread cached format string signatures
+#define SCREEN_MAX_LINES             (128) ///< Pages taller than this are appended rather than redrawn in place
+#define OPTIONS_QUIET                (1 << 8) ///< Internal option flag, take a response without drawing the option bar
+
+/* How a binary log argument is pulled off the va_list */
+typedef enum ConsoleBinlogArg
+{
+    BINLOG_ARG_NONE = 0,
+    BINLOG_ARG_INT,
+    BINLOG_ARG_LONG,
+    BINLOG_ARG_LLONG,
+    BINLOG_ARG_INTMAX,
+    BINLOG_ARG_SIZE,
+    BINLOG_ARG_PTRDIFF,
+    BINLOG_ARG_DOUBLE,
+    BINLOG_ARG_LDOUBLE,
+    BINLOG_ARG_STRING,
+    BINLOG_ARG_POINTER,
+    BINLOG_ARG_SKIP, /* %n, consumed but never printed */
+} ConsoleBinlogArg_e;
+
+/* A parsed printf conversion specification */
+typedef struct ConsoleBinlogSpec
+{
+    ConsoleBinlogArg_e arg;
+    unsigned int       num_stars;    /* Number of '*' width/precision arguments preceding the value */
+    size_t             length_start; /* Offset of the length modifier from the '%' */
+    size_t             length_end;   /* Offset of the conversion character from the '%' */
+    char               conversion;   /* The conversion character, 0 if not recognized */
+} ConsoleBinlogSpec_t;
+
+/* Where we are within an ANSI escape sequence while counting printable characters */
+typedef enum ConsoleEscapeState
+{
+    ESCAPE_STATE_NONE = 0, /* Plain text */
+    ESCAPE_STATE_ESC,      /* Just saw ESC */
+    ESCAPE_STATE_CSI,      /* Inside a control sequence, ESC '[' ... final byte */
+    ESCAPE_STATE_OSC,      /* Inside an operating system command, ESC ']' ... BEL or ST */
+} ConsoleEscapeState_e;
+
+/* A progress meter, the counter sits on its own cache line so the rendering side doesn't slow down the hot loop */
+struct ConsoleProgress
+{
+    atomic_uint_fast64_t count;
+    char                 padding[64 - sizeof(atomic_uint_fast64_t)];
+    LoggingLevel_e       logging_level;
+    const char          *label;
+    uint64_t             total;
+    uint64_t             interval_ns;
+    uint64_t             start_ns;
+    uint64_t             last_render_ns;
+    uint64_t             last_count;
+    double               rate; /* Smoothed items per second */
+    atomic_bool          stop;
+    bool                 has_thread;
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+    pthread_t thread;
+#endif
+};
+
+/* An entry of the menu path index. A path can name a menu, an item or both at once (an item and the sub menu it leads
+ * to often share a name), so an entry has room for either. */
+typedef struct ConsoleMenuIndexEntry
+{
+    uint64_t           hash;
+    char              *path;
+    ConsoleMenu_t     *menu;      /* The menu the path names, NULL if it only names an item */
+    ConsoleMenu_t     *item_menu; /* The menu holding the item the path names */
+    ConsoleMenuItem_t *item;      /* The item the path names, NULL if it only names a menu */
+} ConsoleMenuIndexEntry_t;
+
+typedef enum ConsoleMenuIndexResult
+{
+    MENU_INDEX_ADDED   = 0, // The menu or item was added under the path
+    MENU_INDEX_PRESENT = 1, // The path already names a menu (or an item), nothing changed
+    MENU_INDEX_FAILED  = 2, // Out of memory
+} ConsoleMenuIndexResult_e;
+
+/* A trigram of a menu item's lowercased text and the index of the item, the search index is sorted by both */
+typedef struct ConsoleMenuTrigram
+{
+    uint32_t trigram;
+    uint32_t item;
+} ConsoleMenuTrigram_t;
+
+/* A menu's search index, rebuilt when the menu's items change */
+struct ConsoleMenuSearch
+{
+    ConsoleMenuItem_t    *menu_items;   /* The items the index was built from */
+    unsigned int          menu_length;  /* The number of items the index was built from */
+    unsigned int          generation;   /* The menu's generation when the index was built */
+    char                 *text;         /* Every item's lowercased "name\ndescription", NUL terminated */
+    size_t               *text_offsets; /* Where each item's text starts */
+    ConsoleMenuTrigram_t *trigrams;     /* One entry per distinct trigram in each item, sorted by trigram then item */
+    size_t                num_trigrams; /* The number of entries in trigrams */
+    uint32_t             *marks;        /* Per item stamps for short queries */
+    uint32_t              mark;         /* The current stamp */
+};
+
+/* A binary log record, arguments are stored as 64-bit values (doubles by their bits) or NUL terminated strings */
+typedef struct ConsoleBinlogRecord
+{
+    atomic_size_t  sequence;
+    const char    *format;
+    uint64_t       timestamp;
+    LoggingLevel_e logging_level;
+    uint16_t       args_size;
+    uint8_t        args[BINLOG_ARGS_SIZE];
+} ConsoleBinlogRecord_t;
+
+/* The arguments a format string consumes, cached so the hot path doesn't have to parse the format string */
+typedef struct ConsoleBinlogSignature
+{
+    const char *format;
+    uint8_t     num_args;
+    uint8_t     args[BINLOG_MAX_ARGS];
+} ConsoleBinlogSignature_t;
+
+/* Provide a default console settings struct, console_init() copies the caller's settings over it. The library keeps its
+ * own copy since the exit handler reads the settings after main() has returned and its locals are gone. */
 static ConsoleSettings_t default_console_settings = {
     /* Setup console interface with default settings */
     .splash_screen_pointer = NULL,
@@ -52,73 +209,201 @@ static const ConsoleSelection_t menu_options[] = {
     {'b', "back"      },
     {'n', "next"      },
     {'p', "prev"      },
+    {'/', "search"    },
+    {'g', "go to"     },
     {'q', "quit menus"}
 };
 
-char         string_buffers[NUM_STRING_BUFFERS][STRING_BUFFER_SIZE];
-unsigned int current_string_buffer_index = 0;
+/**
+ * Formatting and output buffers are kept per thread so that any thread can print without taking a lock. The thread that
+ * called console_init() batches its output into frames, every other thread hands each completed line to the sink in a
+ * single call so that lines from different threads never interleave.
+ */
+CONSOLE_THREAD_LOCAL char         string_buffers[NUM_STRING_BUFFERS][STRING_BUFFER_SIZE];
+CONSOLE_THREAD_LOCAL unsigned int current_string_buffer_index = 0;
+
+/* Output is collected here and handed to the sink in as few calls as possible (+1 to NUL terminate for put_string_fn) */
+static CONSOLE_THREAD_LOCAL char   output_buffer[OUTPUT_BUFFER_SIZE + 1];
+static CONSOLE_THREAD_LOCAL size_t output_buffer_length = 0;
+static CONSOLE_THREAD_LOCAL bool   is_console_thread    = false;
+static bool                        flush_at_exit_registered = false;
+
+/* Frame state, a frame that outgrows the output buffer spills into a growable buffer so it still goes out in one write */
+static CONSOLE_THREAD_LOCAL bool                frame_open         = false;
+static CONSOLE_THREAD_LOCAL char               *frame_spill        = NULL;
+static CONSOLE_THREAD_LOCAL size_t              frame_spill_length = 0;
+static CONSOLE_THREAD_LOCAL size_t              frame_spill_size   = 0;
+static CONSOLE_THREAD_LOCAL ConsoleFrameStats_t frame_stats        = {0};
+static CONSOLE_THREAD_LOCAL ConsoleFrameStats_t frame_stats_last   = {0};
+static CONSOLE_THREAD_LOCAL bool                frame_differential = false;
+
+/* Full screen mode keeps the text of the last page drawn, anything else reaching the sink makes it stale */
+static char       *screen_text   = NULL;
+static size_t      screen_length = 0;
+static atomic_bool screen_valid  = false;
+
+/* Headless script state, keys and prompt answers are read from the script instead of the terminal while it's set */
+static FILE            *script_file          = NULL;
+static unsigned int     script_num_keys      = 0;
+static unsigned int     script_num_bad_keys  = 0;
+static unsigned int     script_num_functions = 0;
+static unsigned int     script_num_failures  = 0;
+static FunctionResult_e script_result        = FR_OK;
+
+/* A key read ahead to find out whether the user has typed ahead of the menus, handed out before anything else */
+static char typeahead_key = '\0';
+
+/* Menu path index, an open addressed hash table built by console_init() (size is a power of two, at most half full) */
+static ConsoleMenuIndexEntry_t *menu_index        = NULL;
+static size_t                   menu_index_size   = 0;
+static size_t                   menu_index_length = 0;
+
+/* The current page of a MENU_VIRTUAL menu, as fetched from its page provider */
+static ConsoleMenuItem_t menu_page_items[PAGE_LENGTH];
+
+/* The menu search results are shown in, reused by every search */
+static ConsoleMenu_t       search_results_menu       = {0};
+static ConsoleMenuItem_t  *search_results_items      = NULL;
+static ConsoleMenuItem_t **search_results_sources    = NULL; /* The item each result was copied from */
+static unsigned int        search_results_items_size = 0;
+
+/* Asynchronous logging state, producers only ever touch the atomics and their own queue records */
+static ConsoleAsyncRecord_t  *async_queue           = NULL;
+static size_t                 async_queue_mask      = 0;
+static atomic_size_t          async_enqueue_index   = 0;
+static atomic_size_t          async_dequeue_index   = 0;
+static atomic_bool            async_running         = false;
+static atomic_bool            async_writer_busy     = false;
+static atomic_uint            async_producers       = 0;
+static atomic_uint            async_space_waiters   = 0;
+static atomic_bool            async_writer_waiting  = false;
+static atomic_uint_fast64_t   async_drop_count      = 0;
+static ConsoleAsyncOverflow_e async_overflow_policy = ASYNC_OVERFLOW_BLOCK;
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+static pthread_t async_writer_thread;
+/* Nobody spins: the writer sleeps on async_work while the queue is empty, blocked producers on async_space while it's
+ * full and flushing threads on async_drained until the writer has caught up */
+static pthread_mutex_t async_mutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  async_work    = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  async_space   = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  async_drained = PTHREAD_COND_INITIALIZER;
+#endif
+
+/* Binary logging state */
+static ConsoleBinlogRecord_t *binlog_ring             = NULL;
+static size_t                 binlog_ring_mask        = 0;
+static atomic_size_t          binlog_write_index      = 0;
+static atomic_size_t          binlog_read_index       = 0;
+static atomic_bool            binlog_running          = false;
+static atomic_uint_fast64_t   binlog_drop_count       = 0;
+
+static CONSOLE_THREAD_LOCAL ConsoleBinlogSignature_t binlog_signature_cache[BINLOG_SIGNATURE_CACHE_SIZE];
+
+static void console_sink_write_internal(char *data, size_t length);
+static void console_async_push_internal(const char *data, size_t length);
+static void console_exit_flush_internal(void);
+static char *console_read_line_internal(char *buffer, size_t buff_size);
+static void  console_emit_internal(char *data, size_t length);
+static bool  console_frame_spill_internal(void);
+static void  console_format_internal(char *string_buffer, const char *format, va_list args);
+static bool  console_terminal_capable_internal(void);
+static void  console_screen_begin_internal(void);
+static void  console_screen_redraw_internal(void);
+static void  console_print_options_internal(const ConsoleSelection_t selections[], unsigned int num_selections, unsigned int num_menu_selections, unsigned int num_most_used,
+                                            unsigned int option_flags);
+static char  console_get_response_internal(const ConsoleSelection_t selections[], unsigned int num_selections, unsigned int num_menu_selections, unsigned int num_most_used,
+                                           unsigned int option_flags);
+static uint64_t console_get_time_ns(void);
+static char     console_script_get_char_internal(void);
+static bool     console_input_ended_internal(void);
+static bool     console_typeahead_pending_internal(void);
+static void     console_menu_index_build_internal(ConsoleMenu_t *menu);
+static ConsoleMenuItem_t *console_menu_get_page_internal(ConsoleMenu_t *menu, unsigned int *num_items);
+static unsigned int       console_menu_most_used_internal(ConsoleMenu_t *menu, unsigned int most_used[]);
+static void               console_print_menu_page_internal(ConsoleMenu_t *menu, ConsoleMenuItem_t *page_items, unsigned int num_items, const unsigned int most_used[],
+                                                           unsigned int num_most_used);
 
 /* Maps to TypeEnum_e */
 TypeLookupTableEntry_t console_type_lut[TYPE_MAX] = {
-    {TYPE_NONE,       "",              0            },
-    {TYPE_BOOL_NUM,   "",              sizeof(bool) },
-    {TYPE_BOOL_WORD,  "",              sizeof(bool) },
-    {TYPE_CHAR,       "%c",            sizeof(char) },
-    {TYPE_STRING,     "%s",            0            }, /* Size doesn't make sense for this */
-    {TYPE_FLOAT,      "%f",            sizeof(float)},
-    {TYPE_DEC_INT8,   "%" PRId8,       1            },
-    {TYPE_DEC_INT16,  "%" PRId16,      2            },
-    {TYPE_DEC_INT32,  "%" PRId32,      4            },
-    {TYPE_DEC_INT64,  "%" PRId64,      8            },
-    {TYPE_DEC_UINT8,  "%" PRIu8,       1            },
-    {TYPE_DEC_UINT16, "%" PRIu16,      2            },
-    {TYPE_DEC_UINT32, "%" PRIu32,      4            },
-    {TYPE_DEC_UINT64, "%" PRIu64,      8            },
-    {TYPE_HEX_INT4,   "0x%01" PRIx8,   1            },
-    {TYPE_HEX_INT8,   "0x%02" PRIx8,   1            },
-    {TYPE_HEX_INT12,  "0x%03" PRIx16,  2            },
-    {TYPE_HEX_INT16,  "0x%04" PRIx16,  2            },
-    {TYPE_HEX_INT20,  "0x%05" PRIx32,  4            },
-    {TYPE_HEX_INT24,  "0x%06" PRIx32,  4            },
-    {TYPE_HEX_INT28,  "0x%07" PRIx32,  4            },
-    {TYPE_HEX_INT32,  "0x%08" PRIx32,  4            },
-    {TYPE_HEX_INT36,  "0x%09" PRIx64,  8            },
-    {TYPE_HEX_INT40,  "0x%010" PRIx64, 8            },
-    {TYPE_HEX_INT44,  "0x%011" PRIx64, 8            },
-    {TYPE_HEX_INT48,  "0x%012" PRIx64, 8            },
-    {TYPE_HEX_INT52,  "0x%013" PRIx64, 8            },
-    {TYPE_HEX_INT56,  "0x%014" PRIx64, 8            },
-    {TYPE_HEX_INT60,  "0x%015" PRIx64, 8            },
-    {TYPE_HEX_INT64,  "0x%016" PRIx64, 8            },
-    {TYPE_HEX_UINT4,  "0x%01" PRIx8,   1            },
-    {TYPE_HEX_UINT8,  "0x%02" PRIx8,   1            },
-    {TYPE_HEX_UINT12, "0x%03" PRIx16,  2            },
-    {TYPE_HEX_UINT16, "0x%04" PRIx16,  2            },
-    {TYPE_HEX_UINT20, "0x%05" PRIx32,  4            },
-    {TYPE_HEX_UINT24, "0x%06" PRIx32,  4            },
-    {TYPE_HEX_UINT28, "0x%07" PRIx32,  4            },
-    {TYPE_HEX_UINT32, "0x%08" PRIx32,  4            },
-    {TYPE_HEX_UINT36, "0x%09" PRIx64,  8            },
-    {TYPE_HEX_UINT40, "0x%010" PRIx64, 8            },
-    {TYPE_HEX_UINT44, "0x%011" PRIx64, 8            },
-    {TYPE_HEX_UINT48, "0x%012" PRIx64, 8            },
-    {TYPE_HEX_UINT52, "0x%013" PRIx64, 8            },
-    {TYPE_HEX_UINT56, "0x%014" PRIx64, 8            },
-    {TYPE_HEX_UINT60, "0x%015" PRIx64, 8            },
-    {TYPE_HEX_UINT64, "0x%016" PRIx64, 8            },
+    {TYPE_NONE,       "",              0,             0 },
+    {TYPE_BOOL_NUM,   "",              sizeof(bool),  0 },
+    {TYPE_BOOL_WORD,  "",              sizeof(bool),  0 },
+    {TYPE_CHAR,       "%c",            sizeof(char),  0 },
+    {TYPE_STRING,     "%s",            0,             0 }, /* Size doesn't make sense for this */
+    {TYPE_FLOAT,      "%f",            sizeof(float), 0 },
+    {TYPE_DEC_INT8,   "%" PRId8,       1,             0 },
+    {TYPE_DEC_INT16,  "%" PRId16,      2,             0 },
+    {TYPE_DEC_INT32,  "%" PRId32,      4,             0 },
+    {TYPE_DEC_INT64,  "%" PRId64,      8,             0 },
+    {TYPE_DEC_UINT8,  "%" PRIu8,       1,             0 },
+    {TYPE_DEC_UINT16, "%" PRIu16,      2,             0 },
+    {TYPE_DEC_UINT32, "%" PRIu32,      4,             0 },
+    {TYPE_DEC_UINT64, "%" PRIu64,      8,             0 },
+    {TYPE_HEX_INT4,   "0x%01" PRIx8,   1,             1 },
+    {TYPE_HEX_INT8,   "0x%02" PRIx8,   1,             2 },
+    {TYPE_HEX_INT12,  "0x%03" PRIx16,  2,             3 },
+    {TYPE_HEX_INT16,  "0x%04" PRIx16,  2,             4 },
+    {TYPE_HEX_INT20,  "0x%05" PRIx32,  4,             5 },
+    {TYPE_HEX_INT24,  "0x%06" PRIx32,  4,             6 },
+    {TYPE_HEX_INT28,  "0x%07" PRIx32,  4,             7 },
+    {TYPE_HEX_INT32,  "0x%08" PRIx32,  4,             8 },
+    {TYPE_HEX_INT36,  "0x%09" PRIx64,  8,             9 },
+    {TYPE_HEX_INT40,  "0x%010" PRIx64, 8,             10},
+    {TYPE_HEX_INT44,  "0x%011" PRIx64, 8,             11},
+    {TYPE_HEX_INT48,  "0x%012" PRIx64, 8,             12},
+    {TYPE_HEX_INT52,  "0x%013" PRIx64, 8,             13},
+    {TYPE_HEX_INT56,  "0x%014" PRIx64, 8,             14},
+    {TYPE_HEX_INT60,  "0x%015" PRIx64, 8,             15},
+    {TYPE_HEX_INT64,  "0x%016" PRIx64, 8,             16},
+    {TYPE_HEX_UINT4,  "0x%01" PRIx8,   1,             1 },
+    {TYPE_HEX_UINT8,  "0x%02" PRIx8,   1,             2 },
+    {TYPE_HEX_UINT12, "0x%03" PRIx16,  2,             3 },
+    {TYPE_HEX_UINT16, "0x%04" PRIx16,  2,             4 },
+    {TYPE_HEX_UINT20, "0x%05" PRIx32,  4,             5 },
+    {TYPE_HEX_UINT24, "0x%06" PRIx32,  4,             6 },
+    {TYPE_HEX_UINT28, "0x%07" PRIx32,  4,             7 },
+    {TYPE_HEX_UINT32, "0x%08" PRIx32,  4,             8 },
+    {TYPE_HEX_UINT36, "0x%09" PRIx64,  8,             9 },
+    {TYPE_HEX_UINT40, "0x%010" PRIx64, 8,             10},
+    {TYPE_HEX_UINT44, "0x%011" PRIx64, 8,             11},
+    {TYPE_HEX_UINT48, "0x%012" PRIx64, 8,             12},
+    {TYPE_HEX_UINT52, "0x%013" PRIx64, 8,             13},
+    {TYPE_HEX_UINT56, "0x%014" PRIx64, 8,             14},
+    {TYPE_HEX_UINT60, "0x%015" PRIx64, 8,             15},
+    {TYPE_HEX_UINT64, "0x%016" PRIx64, 8,             16},
 };
 
 void console_init(ConsoleSettings_t *settings)
 {
     memset(string_buffers, 0, sizeof(char) * NUM_STRING_BUFFERS * STRING_BUFFER_SIZE);
     current_string_buffer_index = 0;
-    console_settings            = settings;
+    output_buffer_length        = 0;
+    is_console_thread           = true;
+    default_console_settings    = *settings;
+    console_settings            = &default_console_settings;
+    settings                    = console_settings;
+
+    /* Make sure nothing is left sitting in the output buffer when the program exits */
+    if (!flush_at_exit_registered)
+    {
+        atexit(console_exit_flush_internal);
+        flush_at_exit_registered = true;
+    }
 
     /* Call the OS-specific init function if it's defined */
     if (settings->os_init_fn)
     {
         settings->os_init_fn();
     }
+
+    /* Index every menu and item by path so they can be reached without walking the menus */
+    console_menu_index_build_internal(settings->main_menu_pointer);
+
+    /* Fall back to appending pages if we can't redraw in place */
+    if (settings->full_screen && !console_terminal_capable_internal())
+    {
+        settings->full_screen = false;
+    }
 }
 
 void console_main(void)
@@ -127,18 +412,22 @@ void console_main(void)
 
     for (;;)
     {
-        console_print_new_line(LOGGING_LEVEL_0);
-        console_print_new_line(LOGGING_LEVEL_0);
-        console_print_header(LOGGING_LEVEL_0, "Welcome");
-        for (unsigned int line = 0; line < CONSOLE_HEIGHT; line++)
+        /* Scripts don't need the splash screen */
+        if (!script_file)
         {
-            if (console_settings->splash_screen_pointer)
+            console_print_new_line(LOGGING_LEVEL_0);
+            console_print_new_line(LOGGING_LEVEL_0);
+            console_print_header(LOGGING_LEVEL_0, "Welcome");
+            for (unsigned int line = 0; line < CONSOLE_HEIGHT; line++)
             {
-                if (!strcmp((*(console_settings->splash_screen_pointer))[line], ""))
+                if (console_settings->splash_screen_pointer)
                 {
-                    break;
+                    if (!strcmp((*(console_settings->splash_screen_pointer))[line], ""))
+                    {
+                        break;
+                    }
+                    console_print(LOGGING_LEVEL_0, "%s", (*(console_settings->splash_screen_pointer))[line]);
                 }
-                console_print(LOGGING_LEVEL_0, "%s", (*(console_settings->splash_screen_pointer))[line]);
             }
         }
         selection = console_print_options_and_get_response(splash_options, SELECTION_SIZE(splash_options), 0, 0);
@@ -159,7 +448,11 @@ void console_main(void)
                 console_print_error(LOGGING_LEVEL_0, "%s: Options not implemented.", __FUNCTION__);
                 break;
             case 'q':
-                console_print(LOGGING_LEVEL_0, ANSI_COLOR_CYAN " Bye-bye!\n" ANSI_COLOR_RESET);
+                if (!script_file)
+                {
+                    console_print(LOGGING_LEVEL_0, ANSI_COLOR_CYAN " Bye-bye!\n" ANSI_COLOR_RESET);
+                }
+                console_flush();
                 return;
                 break;
             default:
@@ -180,7 +473,7 @@ unsigned int console_prompt_for_int(const char *prompt, unsigned int default_val
 
     console_print_no_eol(LOGGING_LEVEL_0, "%s (default: %d) > ", prompt, default_val);
 
-    if (fgets(buffer, sizeof(buffer), stdin) == NULL)
+    if (console_read_line_internal(buffer, sizeof(buffer)) == NULL)
     {
         return default_val;
     }
@@ -200,7 +493,7 @@ uint32_t console_prompt_for_hex_uint32(const char *prompt, uint32_t default_val)
 
     console_print_no_eol(LOGGING_LEVEL_0, "%s (default: 0x%x) > ", prompt, default_val);
 
-    if (fgets(buffer, sizeof(buffer), stdin) == NULL)
+    if (console_read_line_internal(buffer, sizeof(buffer)) == NULL)
     {
         return default_val;
     }
@@ -220,7 +513,7 @@ uint64_t console_prompt_for_hex_uint64(const char *prompt, uint64_t default_val)
 
     console_print_no_eol(LOGGING_LEVEL_0, "%s (default: 0x%x) > ", prompt, default_val);
 
-    if (fgets(buffer, sizeof(buffer), stdin) == NULL)
+    if (console_read_line_internal(buffer, sizeof(buffer)) == NULL)
     {
         return default_val;
     }
@@ -249,7 +542,7 @@ char *console_prompt_for_string(const char *prompt, const char *default_val)
         console_print_no_eol(LOGGING_LEVEL_0, "%s (default: %s) > ", prompt, default_val);
     }
 
-    if (fgets(char_buffer, STRING_BUFFER_SIZE, stdin) == NULL)
+    if (console_read_line_internal(char_buffer, STRING_BUFFER_SIZE) == NULL)
     {
         strcpy(string_buffer, default_val);
     }
@@ -280,596 +573,4050 @@ char console_check_for_key_blocking(void)
     return c;
 }
 
-char console_check_for_key(void) { return console_get_char_internal(LOGGING_LEVEL_0); }
+/**
+ * @brief   Check for a key without waiting, returns '\0' if none is queued. Only non-blocking when wait_for_char_fn is
+ *          defined, see console_wait_for_key().
+ */
+char console_check_for_key(void) { return console_wait_for_key(0); }
 
-void console_traverse_menus(ConsoleMenu_t *menu)
+/**
+ * @brief   Wait up to timeout_ms for a key. Returns as soon as a key is queued, or '\0' if none arrives in time, so
+ *          functions can run monitoring loops that stay responsive without spinning. Needs wait_for_char_fn to be
+ *          defined, otherwise this falls back to a blocking get_char_fn.
+ *
+ * @param timeout_ms    How long to wait in milliseconds, 0 to only check, negative to wait forever
+ * @return char         The key, or '\0' on timeout. Once input runs out this keeps returning 'q', as for the end of a
+ *                      script.
+ */
+char console_wait_for_key(int timeout_ms)
 {
-    bool           stay_put     = true;
-    ConsoleMenu_t *current_menu = menu;
-    char           selection;
-    char          *char_pointer;
-    unsigned int   total_pages;
-    unsigned int   num_selections;
-    unsigned int   selected_index;
+    char c;
 
-    do
+    if (typeahead_key || script_file)
     {
-        /* Mutable menus need a function to update them, call it prior to printing the menu out so it's updated. */
-        if (current_menu->mode == MENU_MUTABLE)
+        return console_get_char_internal(LOGGING_LEVEL_0);
+    }
+
+    if (!console_settings->wait_for_char_fn)
+    {
+        return console_get_char_internal(LOGGING_LEVEL_0);
+    }
+
+    /* Whatever we've printed so far must reach the user before we wait on them */
+    console_async_flush();
+    c = console_settings->wait_for_char_fn(timeout_ms);
+    return (c || !console_input_ended_internal()) ? c : 'q';
+}
+
+/**
+ * @brief   Get the next key from the script. Whitespace, control characters and '#' comments running to the end of the
+ *          line are skipped. Once the script runs out this keeps returning 'q' so every menu level quits.
+ */
+static char console_script_get_char_internal(void)
+{
+    int c;
+
+    for (;;)
+    {
+        c = getc(script_file);
+        if (c == EOF)
         {
-            /* ToDo: Assert on null pointer. */
-            current_menu->updater();
+            return 'q';
         }
-
-        /* Determine maximum selection is for this page */
-        if (((current_menu->current_page * PAGE_LENGTH) + PAGE_LENGTH) > current_menu->menu_length)
+        if (c == '#')
         {
-            num_selections = current_menu->menu_length - (current_menu->current_page * PAGE_LENGTH);
+            while (((c = getc(script_file)) != EOF) && (c != '\n'))
+            {
+            }
+            continue;
         }
-        else
+        if (isgraph(c))
         {
-            num_selections = PAGE_LENGTH;
+            script_num_keys++;
+            return (char)c;
         }
+    }
+}
 
-        /* Determine total pages for current menu (do this after a potential menu update) */
-        total_pages = TOTAL_PAGES(current_menu->menu_length);
+/**
+ * @brief   Read a prompt's answer from the script. It's whatever follows the key that led to the prompt on the same line,
+ *          or the next line if nothing does (an empty line takes the default).
+ *
+ * @param buffer    The buffer to read into
+ * @param buff_size The buffer size
+ * @return char*    buffer, or NULL once the script has run out
+ */
+static char *console_script_read_line_internal(char *buffer, size_t buff_size)
+{
+    int c;
 
-        console_print_menu(current_menu);
-        selection = console_print_options_and_get_response(menu_options, SELECTION_SIZE(menu_options), num_selections, 0);
+    while (((c = getc(script_file)) == ' ') || (c == '\t') || (c == '\r'))
+    {
+    }
+    if (c != '\n')
+    {
+        ungetc(c, script_file);
+    }
 
-        selected_index = ((current_menu->current_page * PAGE_LENGTH) + selection - '0');
+    return fgets(buffer, (int)buff_size, script_file);
+}
 
-        /* First check if it's a menu selection (selection should be valid) */
-        if ((unsigned int)selection < (unsigned int)(num_selections + '0'))
+/**
+ * @brief   Report what a function called by a script returned.
+ *
+ * @param menu      The menu the function was called from
+ * @param item      The menu item that was selected
+ * @param result    What the function returned
+ */
+static void console_script_report_internal(ConsoleMenu_t *menu, ConsoleMenuItem_t *item, FunctionResult_e result)
+{
+    script_num_functions++;
+    if (result != FR_OK)
+    {
+        script_num_failures++;
+        if (script_result == FR_OK)
         {
-            /* Error out if we have neither */
-            if ((current_menu->menu_items[selected_index].function_pointer == NO_FUNCTION_POINTER) && (current_menu->menu_items[selected_index].sub_menu == NO_SUB_MENU))
-            {
-                console_print(LOGGING_LEVEL_0, ANSI_COLOR_RED " No submenu or function pointer!!!" ANSI_COLOR_RESET);
-                // for (;;);
-            }
+            script_result = result;
+        }
+    }
+    console_print(LOGGING_LEVEL_0, " %s > %s: %s%s" ANSI_COLOR_RESET, menu->id.name, item->id.name, (result == FR_OK) ? ANSI_COLOR_GREEN : ANSI_COLOR_RED,
+                  console_get_function_result_string(result));
+}
 
-            /**
-             * Note:    A menu item can have both a submenu as well as a function pointer.
-             *          Useful if a function needs to be called prior to entering a new menu.
-             * Check if we have a function pointer
-             */
-            if (current_menu->menu_items[selected_index].function_pointer != NO_FUNCTION_POINTER)
-            {
-                /* ToDo: Handle arguments. */
-                if (MENU_MUTABLE)
-                {
-                    /**
-                     * Pass menu name to first argument of function if menu is mutable
-                     * ToDo: Either insert name at beginning or the end of the argument list when arguments are supported
-                     */
-                    char_pointer = current_menu->menu_items[selected_index].id.name;
-                    current_menu->menu_items[selected_index].function_pointer(1, &char_pointer);
-                }
-                else
-                {
-                    current_menu->menu_items[selected_index].function_pointer(NO_ARGS, NO_ARGS);
-                }
-                /* We stay put after executing a function */
-                /* ToDo: Print function return status */
-            }
+/**
+ * @brief   Drive the menus headlessly from a script of keystrokes, e.g. "m 0 0 b 1 0 q". Keys are read in the order they
+ *          would be typed, starting at the splash screen, and prompts take their answer from the rest of the line (see
+ *          console_script_read_line_internal()). No pages are drawn, only what the functions print plus one line per
+ *          function call with the FunctionResult_e it returned, and a summary at the end. When the script runs out every
+ *          level is quit.
+ *
+ * @param script            The script to read, stays open
+ * @return FunctionResult_e FR_OK if every key was valid and every function returned FR_OK, otherwise the first failure
+ *                          a function returned, or FR_INVALID for bad keys
+ */
+FunctionResult_e console_run_script(FILE *script)
+{
+    bool     full_screen = console_settings->full_screen;
+    uint64_t start_ns;
+    double   elapsed_ms;
 
-            /* Check if we have a submenu */
-            if (current_menu->menu_items[selected_index].sub_menu != NO_SUB_MENU)
-            {
-                current_menu = current_menu->menu_items[selected_index].sub_menu;
-                /* Note! After this point, we've changed menus */
-            }
-        }
-        /* Check if we're traversing up */
-        else if (selection == 'b')
-        {
-            /* Go up if we can */
-            if (current_menu->parent_menu != NO_MAIN_MENU)
-            {
-                /* Reset page */
-                current_menu->current_page = 0;
-                current_menu               = current_menu->parent_menu;
-            }
-        }
-        /* Check if we're traversing to top */
-        else if (selection == 'm')
+    if (!script)
+    {
+        return FR_INVALID;
+    }
+
+    script_file          = script;
+    script_num_keys      = 0;
+    script_num_bad_keys  = 0;
+    script_num_functions = 0;
+    script_num_failures  = 0;
+    script_result        = FR_OK;
+
+    /* There's no page to redraw */
+    console_settings->full_screen = false;
+
+    start_ns = console_get_time_ns();
+    console_main();
+    elapsed_ms = (double)(console_get_time_ns() - start_ns) / 1e6;
+
+    if ((script_result == FR_OK) && script_num_bad_keys)
+    {
+        script_result = FR_INVALID;
+    }
+    console_print(LOGGING_LEVEL_0, " Script: %u keys (%u bad), %u functions (%u failed) in %.3f ms", script_num_keys, script_num_bad_keys, script_num_functions, script_num_failures, elapsed_ms);
+    console_flush();
+
+    console_settings->full_screen = full_screen;
+    script_file                   = NULL;
+
+    return script_result;
+}
+
+/**
+ * @brief   Get the name of a FunctionResult_e, e.g. "FR_OK".
+ */
+const char *console_get_function_result_string(FunctionResult_e result)
+{
+    switch (result)
+    {
+        case FR_OK:
+            return "FR_OK";
+        case FR_FAIL:
+            return "FR_FAIL";
+        case FR_ASSERT_FAIL:
+            return "FR_ASSERT_FAIL";
+        case FR_INVALID:
+            return "FR_INVALID";
+        case FR_TIMEOUT:
+            return "FR_TIMEOUT";
+        case FR_NOMEM:
+            return "FR_NOMEM";
+        case FR_NOACCESS:
+            return "FR_NOACCESS";
+        case FR_NOTFOUND:
+            return "FR_NOTFOUND";
+        case FR_BUSY:
+            return "FR_BUSY";
+        case FR_DISCONNECT:
+            return "FR_DISCONNECT";
+        case FR_UNSUPPORTED:
+            return "FR_UNSUPPORTED";
+        default:
+            return "FR_UNKNOWN";
+    }
+}
+
+/**
+ * @brief   FNV-1a hash of a menu path.
+ */
+static uint64_t console_menu_hash_internal(const char *path, size_t length)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (uint8_t)path[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief   Find the slot for a path in the menu index, either the entry holding it or the empty slot it would go in.
+ */
+static ConsoleMenuIndexEntry_t *console_menu_index_slot_internal(ConsoleMenuIndexEntry_t *index, size_t index_size, const char *path, uint64_t hash)
+{
+    size_t slot = (size_t)hash & (index_size - 1);
+
+    while (index[slot].path && ((index[slot].hash != hash) || strcmp(index[slot].path, path)))
+    {
+        slot = (slot + 1) & (index_size - 1);
+    }
+
+    return &index[slot];
+}
+
+/**
+ * @brief   Add a menu or an item to the menu index under a path, growing the index as needed. Menus and items don't get in
+ *          each other's way, a path can name one of each.
+ *
+ * @param path                      The path, copied into the index
+ * @param length                    The length of the path
+ * @param menu                      The menu the path names, or that holds the item
+ * @param item                      The item the path names, NULL for a menu
+ * @return ConsoleMenuIndexResult_e MENU_INDEX_ADDED, MENU_INDEX_PRESENT if the path already names a menu (for a menu) or
+ *                                  an item (for an item), MENU_INDEX_FAILED if we ran out of memory
+ */
+static ConsoleMenuIndexResult_e console_menu_index_add_internal(const char *path, size_t length, ConsoleMenu_t *menu, ConsoleMenuItem_t *item)
+{
+    uint64_t                 hash = console_menu_hash_internal(path, length);
+    ConsoleMenuIndexEntry_t *entry;
+
+    if ((menu_index_length + 1) * 2 > menu_index_size)
+    {
+        size_t                   new_size  = menu_index_size ? (menu_index_size * 2) : 64;
+        ConsoleMenuIndexEntry_t *new_index = (ConsoleMenuIndexEntry_t *)calloc(new_size, sizeof(ConsoleMenuIndexEntry_t));
+
+        if (!new_index)
         {
-            /* Go up until we hit top menu */
-            while (current_menu->parent_menu != NO_MAIN_MENU)
-            {
-                /* Reset page */
-                current_menu->current_page = 0;
-                current_menu               = current_menu->parent_menu;
-            };
+            return MENU_INDEX_FAILED;
         }
-        /* Check if we're going to the previous page */
-        else if (selection == 'p')
+        for (size_t i = 0; i < menu_index_size; i++)
         {
-            /* Only valid if we have more than one page and we aren't on the first page */
-            if ((total_pages > 1) && (current_menu->current_page > 0))
+            if (menu_index[i].path)
             {
-                current_menu->current_page--;
+                *console_menu_index_slot_internal(new_index, new_size, menu_index[i].path, menu_index[i].hash) = menu_index[i];
             }
         }
-        /* Check if we're going to the next page */
-        else if (selection == 'n')
+        free(menu_index);
+        menu_index      = new_index;
+        menu_index_size = new_size;
+    }
+
+    entry = console_menu_index_slot_internal(menu_index, menu_index_size, path, hash);
+    if (!entry->path)
+    {
+        entry->path = (char *)malloc(length + 1);
+        if (!entry->path)
         {
-            /* Only valid if we have more than one page and we aren't on the last page */
-            if ((total_pages > 1) && (current_menu->current_page < (total_pages - 1)))
-            {
-                current_menu->current_page++;
-            }
+            return MENU_INDEX_FAILED;
         }
-        /* Check if we're quitting */
-        else if (selection == 'q')
+        memcpy(entry->path, path, length + 1);
+        entry->hash = hash;
+        menu_index_length++;
+    }
+
+    if (item)
+    {
+        if (entry->item)
         {
-            stay_put = false;
+            return MENU_INDEX_PRESENT;
         }
-        else
+        entry->item_menu = menu;
+        entry->item      = item;
+    }
+    else
+    {
+        if (entry->menu)
         {
-            console_print(LOGGING_LEVEL_0, ANSI_COLOR_RED " Something went wrong..." ANSI_COLOR_RESET);
-            for (;;)
-                ;
+            return MENU_INDEX_PRESENT;
         }
-    } while (stay_put);
+        entry->menu = menu;
+    }
+
+    return MENU_INDEX_ADDED;
 }
 
-char console_print_options_and_get_response(const ConsoleSelection_t selections[], unsigned int num_selections, unsigned int num_menu_selections, unsigned int option_flags)
+/**
+ * @brief   Index a menu and its items under the path in path[0..length), then recurse into its sub menus. A menu that's
+ *          reachable from several items is indexed once under each distinct path, a sub menu that leads back up the
+ *          tree stops at MENU_PATH_MAX_DEPTH. Items of MENU_MUTABLE and MENU_VIRTUAL menus change at run time so only the
+ *          menu is indexed.
+ *
+ * @return true     Indexed (or skipped)
+ * @return false    We ran out of memory
+ */
+static bool console_menu_index_add_menu_internal(ConsoleMenu_t *menu, char *path, size_t length, unsigned int depth)
 {
-    /* ToDo: Assert on number of menu selections greater than 10 */
-    char c;
-    bool valid = false;
+    size_t                   name_length = strlen(menu->id.name);
+    ConsoleMenuIndexResult_e result;
 
-    do
+    if ((depth >= MENU_PATH_MAX_DEPTH) || ((length + name_length + 1) >= MENU_PATH_MAX_LENGTH))
     {
-        if (!(option_flags & NO_DIVIDERS))
-        {
-            console_print_divider(LOGGING_LEVEL_0);
-        }
-        else
-        {
-            console_print_new_line(LOGGING_LEVEL_0);
-        }
-        /* Print menu selections (these will override any conflicting passed in selections) */
-        if (num_menu_selections != 0)
-        {
-            console_print_no_eol(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW "0" ANSI_COLOR_RESET "-" ANSI_COLOR_YELLOW "%c" ANSI_COLOR_RESET "]-item ", ('0' + (num_menu_selections - 1)));
-        }
-        /* Print passed in selections */
-        for (unsigned int i = 0; i < num_selections; i++)
+        return true;
+    }
+    if (length)
+    {
+        path[length++] = MENU_PATH_SEPARATOR;
+    }
+    memcpy(&path[length], menu->id.name, name_length + 1);
+    length += name_length;
+
+    /* Already indexed along this path */
+    result = console_menu_index_add_internal(path, length, menu, NULL);
+    if ((result != MENU_INDEX_ADDED) || (menu->mode != MENU_DEFAULT))
+    {
+        return result != MENU_INDEX_FAILED;
+    }
+
+    for (unsigned int i = 0; i < menu->menu_length; i++)
+    {
+        ConsoleMenuItem_t *item             = &menu->menu_items[i];
+        size_t             item_name_length = strlen(item->id.name);
+
+        if ((length + item_name_length + 1) < MENU_PATH_MAX_LENGTH)
         {
-            console_print_no_eol(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW "%c" ANSI_COLOR_RESET "]-%s ", selections[i].key, selections[i].description);
-            if ((option_flags & ORIENTATION_V) && !(i == (num_selections - 1)))
+            path[length] = MENU_PATH_SEPARATOR;
+            memcpy(&path[length + 1], item->id.name, item_name_length + 1);
+            if (console_menu_index_add_internal(path, length + 1 + item_name_length, menu, item) == MENU_INDEX_FAILED)
             {
-                console_print_new_line(LOGGING_LEVEL_0);
+                return false;
             }
         }
-        console_print_new_line(LOGGING_LEVEL_0);
-        if (!(option_flags & NO_DIVIDERS))
-        {
-            console_print_divider(LOGGING_LEVEL_0);
-        }
-        else
+        if ((item->sub_menu != NO_SUB_MENU) && !console_menu_index_add_menu_internal(item->sub_menu, path, length, depth + 1))
         {
-            console_print_new_line(LOGGING_LEVEL_0);
+            return false;
         }
-        console_print_no_eol(LOGGING_LEVEL_0, " Selection > ");
-        c = console_check_for_key_blocking();
+    }
 
-        /* If we have menu selections, check for those first */
-        if (num_menu_selections != 0)
-        {
-            /* Check if it's a valid menu selection */
-            if ((unsigned int)(c - '0') < num_menu_selections)
+    return true;
+}
+
+/**
+ * @brief   (Re)build the menu path index from the main menu.
+ */
+static void console_menu_index_build_internal(ConsoleMenu_t *menu)
+{
+    char path[MENU_PATH_MAX_LENGTH];
+
+    for (size_t i = 0; i < menu_index_size; i++)
+    {
+        free(menu_index[i].path);
+    }
+    free(menu_index);
+    menu_index        = NULL;
+    menu_index_size   = 0;
+    menu_index_length = 0;
+
+    if (menu && !console_menu_index_add_menu_internal(menu, path, 0, 0))
+    {
+        console_print_error(LOGGING_LEVEL_0, "%s: Out of memory, the menu path index is incomplete!", __FUNCTION__);
+    }
+}
+
+/**
+ * @brief   Look up a menu or menu item by its path, the names from the main menu down joined by MENU_PATH_SEPARATOR, e.g.
+ *          "Main Menu/Sub Menu/Hello". A sub menu is named by its own name rather than the item leading to it. A path that
+ *          names both an item and a menu (an item and its sub menu sharing a name) finds the item. The index is built by
+ *          console_init(), so this is a single hash lookup.
+ *
+ * @param path              The path to look up
+ * @param menu              Set to the menu the path names, or the menu holding the item (may be NULL)
+ * @param item              Set to the item the path names, NULL if it names a menu (may be NULL)
+ * @return FunctionResult_e FR_OK if found, FR_NOTFOUND otherwise
+ */
+FunctionResult_e console_menu_find(const char *path, ConsoleMenu_t **menu, ConsoleMenuItem_t **item)
+{
+    ConsoleMenuIndexEntry_t *entry;
+
+    if (!menu_index || !path)
+    {
+        return FR_NOTFOUND;
+    }
+
+    entry = console_menu_index_slot_internal(menu_index, menu_index_size, path, console_menu_hash_internal(path, strlen(path)));
+    if (!entry->path)
+    {
+        return FR_NOTFOUND;
+    }
+
+    if (menu)
+    {
+        *menu = entry->item ? entry->item_menu : entry->menu;
+    }
+    if (item)
+    {
+        *item = entry->item;
+    }
+
+    return FR_OK;
+}
+
+/**
+ * @brief   Call the function of the menu item at path directly, without drawing any of the menus leading to it. The
+ *          function gets the item name as its argument, as it would from console_traverse_menus(). A path naming a menu,
+ *          or an item with only a sub menu, starts traversing the menus from that menu instead.
+ *
+ * @param path              The path of the item, see console_menu_find()
+ * @return FunctionResult_e What the function returned, FR_OK after traversing, FR_NOTFOUND for an unknown path and
+ *                          FR_INVALID for an item with neither a function nor a sub menu
+ */
+FunctionResult_e console_menu_invoke(const char *path)
+{
+    ConsoleMenu_t     *menu;
+    ConsoleMenuItem_t *item;
+    char              *char_pointer;
+
+    if (console_menu_find(path, &menu, &item) != FR_OK)
+    {
+        return FR_NOTFOUND;
+    }
+
+    if (item)
+    {
+        item->use_count++;
+    }
+    if (item && (item->function_pointer != NO_FUNCTION_POINTER))
+    {
+        char_pointer = item->id.name;
+        return item->function_pointer(1, &char_pointer);
+    }
+
+    if (item)
+    {
+        menu = item->sub_menu;
+    }
+    if (menu == NO_SUB_MENU)
+    {
+        return FR_INVALID;
+    }
+
+    console_traverse_menus(menu);
+    return FR_OK;
+}
+
+/**
+ * @brief   Sort trigram index entries by trigram, two stable 12-bit radix passes. Entries are generated in item order so
+ *          they end up sorted by item within each trigram too.
+ *
+ * @param trigrams      The entries to sort
+ * @param num_trigrams  The number of entries
+ * @return true         Sorted
+ * @return false        We ran out of memory
+ */
+static bool console_menu_trigram_sort_internal(ConsoleMenuTrigram_t *trigrams, size_t num_trigrams)
+{
+    ConsoleMenuTrigram_t *scratch = (ConsoleMenuTrigram_t *)malloc((num_trigrams + 1) * sizeof(ConsoleMenuTrigram_t));
+    size_t               *counts  = (size_t *)malloc(4096 * sizeof(size_t));
+
+    if (!scratch || !counts)
+    {
+        free(scratch);
+        free(counts);
+        return false;
+    }
+
+    for (unsigned int shift = 0; shift < 24; shift += 12)
+    {
+        ConsoleMenuTrigram_t *from  = (shift == 0) ? trigrams : scratch;
+        ConsoleMenuTrigram_t *to    = (shift == 0) ? scratch : trigrams;
+        size_t                total = 0;
+
+        memset(counts, 0, 4096 * sizeof(size_t));
+        for (size_t i = 0; i < num_trigrams; i++)
+        {
+            counts[(from[i].trigram >> shift) & 0xfff]++;
+        }
+        for (size_t i = 0; i < 4096; i++)
+        {
+            size_t count = counts[i];
+
+            counts[i] = total;
+            total += count;
+        }
+        for (size_t i = 0; i < num_trigrams; i++)
+        {
+            to[counts[(from[i].trigram >> shift) & 0xfff]++] = from[i];
+        }
+    }
+
+    free(scratch);
+    free(counts);
+    return true;
+}
+
+/**
+ * @brief   Find the first trigram index entry not below trigram.
+ */
+static size_t console_menu_trigram_lower_bound_internal(const struct ConsoleMenuSearch *search, uint32_t trigram)
+{
+    size_t low  = 0;
+    size_t high = search->num_trigrams;
+
+    while (low < high)
+    {
+        size_t middle = low + ((high - low) / 2);
+
+        if (search->trigrams[middle].trigram < trigram)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief   Build (or rebuild) a menu's search index. Every position in an item's lowercased name and description starts
+ *          a trigram, padded with NULs at the end, so any query of up to three characters is a prefix of some trigram.
+ *          Longer queries only check the items holding the query's rarest trigram with strstr().
+ *
+ * @param menu      The menu to index
+ * @return true     The index is ready
+ * @return false    We ran out of memory
+ */
+static bool console_menu_search_build_internal(ConsoleMenu_t *menu)
+{
+    struct ConsoleMenuSearch *search       = menu->search;
+    size_t                    text_length  = 0;
+    size_t                    num_trigrams = 0;
+
+    if (!search)
+    {
+        search = (struct ConsoleMenuSearch *)calloc(1, sizeof(struct ConsoleMenuSearch));
+        if (!search)
+        {
+            return false;
+        }
+        menu->search = search;
+    }
+    free(search->text);
+    free(search->text_offsets);
+    free(search->trigrams);
+    free(search->marks);
+    memset(search, 0, sizeof(*search));
+
+    for (unsigned int i = 0; i < menu->menu_length; i++)
+    {
+        text_length += strlen(menu->menu_items[i].id.name) + strlen(menu->menu_items[i].id.description) + 2;
+    }
+
+    search->text         = (char *)malloc(text_length + 1);
+    search->text_offsets = (size_t *)malloc((menu->menu_length + 1) * sizeof(size_t));
+    search->trigrams     = (ConsoleMenuTrigram_t *)malloc((text_length + 1) * sizeof(ConsoleMenuTrigram_t));
+    search->marks        = (uint32_t *)calloc(menu->menu_length + 1, sizeof(uint32_t));
+    if (!search->text || !search->text_offsets || !search->trigrams || !search->marks)
+    {
+        return false;
+    }
+
+    text_length = 0;
+    for (unsigned int i = 0; i < menu->menu_length; i++)
+    {
+        char  *text = &search->text[text_length];
+        size_t length;
+
+        length = (size_t)sprintf(text, "%s\n%s", menu->menu_items[i].id.name, menu->menu_items[i].id.description);
+        for (size_t j = 0; j < length; j++)
+        {
+            text[j] = (char)tolower((unsigned char)text[j]);
+        }
+        for (size_t j = 0; j < length; j++)
+        {
+            uint32_t c1 = ((j + 1) < length) ? (uint8_t)text[j + 1] : 0;
+            uint32_t c2 = ((j + 2) < length) ? (uint8_t)text[j + 2] : 0;
+
+            search->trigrams[num_trigrams].trigram = ((uint32_t)(uint8_t)text[j] << 16) | (c1 << 8) | c2;
+            search->trigrams[num_trigrams].item    = i;
+            num_trigrams++;
+        }
+        search->text_offsets[i] = text_length;
+        text_length += length + 1;
+    }
+
+    /* Sort, then drop the repeats of a trigram within the same item */
+    if (!console_menu_trigram_sort_internal(search->trigrams, num_trigrams))
+    {
+        return false;
+    }
+    search->num_trigrams = 0;
+    for (size_t i = 0; i < num_trigrams; i++)
+    {
+        if ((search->num_trigrams == 0) || (search->trigrams[search->num_trigrams - 1].trigram != search->trigrams[i].trigram) ||
+            (search->trigrams[search->num_trigrams - 1].item != search->trigrams[i].item))
+        {
+            search->trigrams[search->num_trigrams++] = search->trigrams[i];
+        }
+    }
+
+    search->menu_items  = menu->menu_items;
+    search->menu_length = menu->menu_length;
+    search->generation  = menu->generation;
+
+    return true;
+}
+
+/**
+ * @brief   Find the items of a menu whose name or description contains query, ignoring case. Uses the menu's trigram
+ *          index, built on the first search and rebuilt if the menu's items have been replaced or its generation has
+ *          moved on, so each search only touches the items that share the query's trigrams instead of scanning every
+ *          item.
+ *
+ * @param menu          The menu to search
+ * @param query         What to look for, an empty query matches every item
+ * @param results       Set to the indices of the matching items in menu order (may be NULL)
+ * @param max_results   The size of results
+ * @return unsigned int The number of matching items, which can be more than max_results
+ */
+unsigned int console_menu_search(ConsoleMenu_t *menu, const char *query, unsigned int *results, unsigned int max_results)
+{
+    struct ConsoleMenuSearch *search      = menu->search;
+    size_t                    length      = 0;
+    unsigned int              num_matches = 0;
+    char                      lowered[MENU_SEARCH_QUERY_LENGTH + 1];
+
+    /* Only the current page of a virtual menu is ever fetched */
+    if (menu->mode == MENU_VIRTUAL)
+    {
+        return 0;
+    }
+
+    if (!search || (search->menu_items != menu->menu_items) || (search->menu_length != menu->menu_length) || (search->generation != menu->generation))
+    {
+        if (!console_menu_search_build_internal(menu))
+        {
+            return 0;
+        }
+        search = menu->search;
+    }
+
+    while (query[length] && (length < MENU_SEARCH_QUERY_LENGTH))
+    {
+        lowered[length] = (char)tolower((unsigned char)query[length]);
+        length++;
+    }
+    lowered[length] = '\0';
+
+    if (length == 0)
+    {
+        for (unsigned int i = 0; i < menu->menu_length; i++)
+        {
+            if (num_matches < max_results)
+            {
+                results[num_matches] = i;
+            }
+            num_matches++;
+        }
+    }
+    else if (length < 3)
+    {
+        /* Every trigram starting with the query is a hit, they're all in one range of the index */
+        uint32_t prefix = ((uint32_t)(uint8_t)lowered[0] << 16) | ((length == 2) ? ((uint32_t)(uint8_t)lowered[1] << 8) : 0);
+        uint32_t span   = (length == 2) ? 0x100 : 0x10000;
+        size_t   end    = console_menu_trigram_lower_bound_internal(search, prefix + span);
+
+        if (++search->mark == 0)
+        {
+            memset(search->marks, 0, search->menu_length * sizeof(uint32_t));
+            search->mark = 1;
+        }
+        for (size_t i = console_menu_trigram_lower_bound_internal(search, prefix); i < end; i++)
+        {
+            search->marks[search->trigrams[i].item] = search->mark;
+        }
+        for (unsigned int i = 0; i < search->menu_length; i++)
+        {
+            if (search->marks[i] == search->mark)
+            {
+                if (num_matches < max_results)
+                {
+                    results[num_matches] = i;
+                }
+                num_matches++;
+            }
+        }
+    }
+    else
+    {
+        size_t starts[MENU_SEARCH_QUERY_LENGTH];
+        size_t ends[MENU_SEARCH_QUERY_LENGTH];
+        size_t num_query_trigrams = length - 2;
+        size_t rarest             = 0;
+
+        /* Look up the items of every trigram in the query, any missing one rules everything out */
+        for (size_t i = 0; i < num_query_trigrams; i++)
+        {
+            uint32_t trigram = ((uint32_t)(uint8_t)lowered[i] << 16) | ((uint32_t)(uint8_t)lowered[i + 1] << 8) | (uint8_t)lowered[i + 2];
+
+            starts[i] = console_menu_trigram_lower_bound_internal(search, trigram);
+            ends[i]   = console_menu_trigram_lower_bound_internal(search, trigram + 1);
+            if (starts[i] == ends[i])
+            {
+                return 0;
+            }
+            if ((ends[i] - starts[i]) < (ends[rarest] - starts[rarest]))
+            {
+                rarest = i;
+            }
+        }
+
+        /* The rarest trigram's items are the only candidates, checking them directly beats intersecting the rest */
+        for (size_t i = starts[rarest]; i < ends[rarest]; i++)
+        {
+            uint32_t item = search->trigrams[i].item;
+
+            if (strstr(&search->text[search->text_offsets[item]], lowered))
+            {
+                if (num_matches < max_results)
+                {
+                    results[num_matches] = item;
+                }
+                num_matches++;
+            }
+        }
+    }
+
+    return num_matches;
+}
+
+/**
+ * @brief   Interactive search over a menu's items. Each key narrows the match count shown on the prompt line, Enter
+ *          accepts and backspace on an empty query cancels. Scripts give the whole query on one line instead.
+ *
+ * @param menu              The menu to search, searching from the results searches the menu they came from
+ * @return ConsoleMenu_t*   A menu listing the matching items (its parent is the searched menu), NULL if cancelled or
+ *                          nothing matched
+ */
+static ConsoleMenu_t *console_menu_search_interactive_internal(ConsoleMenu_t *menu)
+{
+    char          query[MENU_SEARCH_QUERY_LENGTH + 1] = {0};
+    size_t        length                              = 0;
+    unsigned int  first_match                         = 0;
+    unsigned int  num_matches;
+    unsigned int *indices;
+    char          c;
+
+    if (menu == &search_results_menu)
+    {
+        menu = search_results_menu.parent_menu;
+    }
+
+    if (menu->mode == MENU_VIRTUAL)
+    {
+        if (script_file)
+        {
+            console_read_line_internal(query, sizeof(query));
+        }
+        console_print_warn(LOGGING_LEVEL_0, "%s can't be searched, its items are fetched a page at a time", menu->id.name);
+        return NULL;
+    }
+
+    if (script_file)
+    {
+        if (console_read_line_internal(query, sizeof(query)))
+        {
+            length = strcspn(query, "\r\n");
+            query[length] = '\0';
+        }
+        num_matches = console_menu_search(menu, query, &first_match, 1);
+    }
+    else
+    {
+        for (;;)
+        {
+            num_matches = console_menu_search(menu, query, &first_match, 1);
+            if (!console_typeahead_pending_internal())
+            {
+                console_print_in_place(LOGGING_LEVEL_0, " Search > " ANSI_COLOR_YELLOW "%s" ANSI_COLOR_RESET "_  (%u of %u%s%s)", query, num_matches, menu->menu_length,
+                                       num_matches ? ", first: " : "", num_matches ? menu->menu_items[first_match].id.name : "");
+            }
+            c = console_check_for_key_blocking();
+            /* Nothing more is coming, give up on the search */
+            if (console_input_ended_internal())
+            {
+                console_print_new_line(LOGGING_LEVEL_0);
+                return NULL;
+            }
+            if ((c == '\n') || (c == '\r'))
+            {
+                break;
+            }
+            if ((c == '\b') || (c == 0x7f))
+            {
+                if (length == 0)
+                {
+                    console_print_new_line(LOGGING_LEVEL_0);
+                    return NULL;
+                }
+                query[--length] = '\0';
+            }
+            else if (isprint((unsigned char)c) && (length < MENU_SEARCH_QUERY_LENGTH))
+            {
+                query[length++] = c;
+                query[length]   = '\0';
+            }
+        }
+        console_print_new_line(LOGGING_LEVEL_0);
+    }
+
+    if (num_matches == 0)
+    {
+        console_print_warn(LOGGING_LEVEL_0, "No items match \"%s\"", query);
+        return NULL;
+    }
+
+    if (num_matches > search_results_items_size)
+    {
+        ConsoleMenuItem_t  *items   = (ConsoleMenuItem_t *)realloc(search_results_items, num_matches * sizeof(ConsoleMenuItem_t));
+        ConsoleMenuItem_t **sources = items ? (ConsoleMenuItem_t **)realloc(search_results_sources, num_matches * sizeof(ConsoleMenuItem_t *)) : NULL;
+
+        if (items)
+        {
+            search_results_items = items;
+        }
+        if (!sources)
+        {
+            return NULL;
+        }
+        search_results_sources    = sources;
+        search_results_items_size = num_matches;
+    }
+
+    indices = (unsigned int *)malloc(num_matches * sizeof(unsigned int));
+    if (!indices)
+    {
+        return NULL;
+    }
+    console_menu_search(menu, query, indices, num_matches);
+    for (unsigned int i = 0; i < num_matches; i++)
+    {
+        search_results_items[i]   = menu->menu_items[indices[i]];
+        search_results_sources[i] = &menu->menu_items[indices[i]];
+    }
+    free(indices);
+
+    snprintf(search_results_menu.id.name, sizeof(search_results_menu.id.name), "Search: %s", query);
+    snprintf(search_results_menu.id.description, sizeof(search_results_menu.id.description), "%u of %u items in %.40s", num_matches, menu->menu_length, menu->id.name);
+    search_results_menu.menu_items   = search_results_items;
+    search_results_menu.parent_menu  = menu;
+    search_results_menu.menu_length  = num_matches;
+    search_results_menu.current_page = FIRST_PAGE;
+    search_results_menu.mode         = MENU_DEFAULT;
+    search_results_menu.updater      = NULL;
+    search_results_menu.generation++;
+
+    return &search_results_menu;
+}
+
+/**
+ * @brief   Ask for the number of an item anywhere in the menu, then move to its page. Digits, backspace and Enter, or
+ *          the rest of the line in a script.
+ *
+ * @param menu                  The menu
+ * @param page_items            Set to the items on the new page
+ * @param num_items             Set to the number of items on the new page
+ * @return ConsoleMenuItem_t*   The item, NULL if cancelled or there's no such item (which is reported here)
+ */
+static ConsoleMenuItem_t *console_menu_goto_internal(ConsoleMenu_t *menu, ConsoleMenuItem_t **page_items, unsigned int *num_items)
+{
+    char          number[32] = {0};
+    size_t        length     = 0;
+    char         *end;
+    unsigned long index;
+    char          c;
+
+    if (script_file)
+    {
+        if (console_read_line_internal(number, sizeof(number)))
+        {
+            length         = strcspn(number, "\r\n");
+            number[length] = '\0';
+        }
+    }
+    else if (menu->menu_length)
+    {
+        for (;;)
+        {
+            if (!console_typeahead_pending_internal())
+            {
+                console_print_in_place(LOGGING_LEVEL_0, " Go to item > " ANSI_COLOR_YELLOW "%s" ANSI_COLOR_RESET "_  (0-%u)", number, menu->menu_length - 1);
+            }
+            c = console_check_for_key_blocking();
+            /* Nothing more is coming, give up on the item */
+            if (console_input_ended_internal())
+            {
+                console_print_new_line(LOGGING_LEVEL_0);
+                return NULL;
+            }
+            if (c == '\n')
+            {
+                break;
+            }
+            if (c == '\b')
+            {
+                if (length == 0)
+                {
+                    console_print_new_line(LOGGING_LEVEL_0);
+                    return NULL;
+                }
+                number[--length] = '\0';
+            }
+            else if (isdigit((unsigned char)c) && (length < (sizeof(number) - 1)))
+            {
+                number[length++] = c;
+                number[length]   = '\0';
+            }
+        }
+        console_print_new_line(LOGGING_LEVEL_0);
+    }
+
+    index = strtoul(number, &end, 10);
+    if ((end == number) || (index >= menu->menu_length))
+    {
+        console_print_warn(LOGGING_LEVEL_0, "%s has no item %s", menu->id.name, number);
+        return NULL;
+    }
+
+    menu->current_page = (unsigned int)(index / PAGE_LENGTH);
+    *page_items        = console_menu_get_page_internal(menu, num_items);
+
+    /* A virtual menu's provider may hand back a shorter page than the menu length promised */
+    if ((index % PAGE_LENGTH) >= *num_items)
+    {
+        console_print_warn(LOGGING_LEVEL_0, "%s has no item %s", menu->id.name, number);
+        return NULL;
+    }
+
+    return &(*page_items)[index % PAGE_LENGTH];
+}
+
+/**
+ * @brief   Rank a menu's items by how often they've been selected, for its most used section. Only menus with more than
+ *          one page get one, and virtual menus never do since only their current page is to hand.
+ *
+ * @param menu          The menu
+ * @param most_used     Set to the indices of the most used items, most used first (ties in menu order)
+ * @return unsigned int The number of most used items, up to the most_used_length setting
+ */
+static unsigned int console_menu_most_used_internal(ConsoleMenu_t *menu, unsigned int most_used[])
+{
+    unsigned int length      = (console_settings->most_used_length > MENU_MOST_USED_MAX) ? MENU_MOST_USED_MAX : console_settings->most_used_length;
+    unsigned int num_entries = 0;
+
+    if ((length == 0) || (menu->mode == MENU_VIRTUAL) || (TOTAL_PAGES(menu->menu_length) <= 1))
+    {
+        return 0;
+    }
+
+    for (unsigned int i = 0; i < menu->menu_length; i++)
+    {
+        unsigned int use_count = menu->menu_items[i].use_count;
+        unsigned int slot;
+
+        if ((use_count == 0) || ((num_entries == length) && (use_count <= menu->menu_items[most_used[num_entries - 1]].use_count)))
+        {
+            continue;
+        }
+
+        /* Insert into the short ranked list, dropping the last entry if it's full */
+        slot = (num_entries < length) ? num_entries++ : (num_entries - 1);
+        while ((slot > 0) && (menu->menu_items[most_used[slot - 1]].use_count < use_count))
+        {
+            most_used[slot] = most_used[slot - 1];
+            slot--;
+        }
+        most_used[slot] = i;
+    }
+
+    return num_entries;
+}
+
+/**
+ * @brief   Tell the menus that a menu's items have changed, e.g. from whatever notices the change, so the next render
+ *          fetches them again (calling the updater of a MENU_MUTABLE menu) and drops its search index.
+ *
+ * @param menu  The menu that changed
+ */
+void console_menu_mark_changed(ConsoleMenu_t *menu) { menu->generation++; }
+
+/**
+ * @brief   Check whether the user has typed ahead of the menus, reading one key ahead without waiting if need be. Only
+ *          possible with a wait_for_char_fn, and never while a script is running (nothing is drawn then anyway).
+ *
+ * @return true     A key is waiting, the next console_get_char_internal() returns it
+ * @return false    Nothing has been typed yet
+ */
+static bool console_typeahead_pending_internal(void)
+{
+    if (!typeahead_key && !script_file && console_settings->wait_for_char_fn)
+    {
+        typeahead_key = console_settings->wait_for_char_fn(0);
+    }
+
+    return typeahead_key != '\0';
+}
+
+void console_traverse_menus(ConsoleMenu_t *menu)
+{
+    bool               stay_put     = true;
+    ConsoleMenu_t     *current_menu = menu;
+    char               selection;
+    char              *char_pointer;
+    unsigned int       total_pages;
+    unsigned int       num_selections = 0;
+    ConsoleMenuItem_t *page_items     = NULL;
+    ConsoleMenuItem_t *selected_item;
+    ConsoleMenuItem_t  virtual_item;
+    FunctionResult_e   result;
+    unsigned int       most_used[MENU_MOST_USED_MAX];
+    unsigned int       num_most_used    = 0;
+    ConsoleMenu_t     *drawn_menu       = NULL;
+    unsigned int       drawn_page       = 0;
+    unsigned int       drawn_generation = 0;
+    bool               function_called  = false;
+    bool               stale;
+    bool               redraw;
+    bool               shown            = false;
+    bool               typed_ahead;
+
+    do
+    {
+        /* A menu's items only need fetching again if we've just entered it, run one of its functions or been told */
+        stale = (current_menu != drawn_menu) || function_called || (current_menu->generation != drawn_generation) ||
+                (current_menu->changed && current_menu->changed(current_menu));
+        function_called = false;
+
+        /* Mutable menus need a function to update them, call it prior to printing the menu out so it's updated. */
+        if ((current_menu->mode == MENU_MUTABLE) && stale)
+        {
+            /* ToDo: Assert on null pointer. */
+            current_menu->updater();
+            current_menu->generation++;
+        }
+
+        /* Get this page's items, the number of them is the maximum selection. Nothing to do after a key that changed
+         * nothing, e.g. 'p' on the first page, the page is still the one drawn last time. */
+        redraw = stale || (current_menu->current_page != drawn_page);
+        if (redraw)
+        {
+            page_items       = console_menu_get_page_internal(current_menu, &num_selections);
+            num_most_used    = console_menu_most_used_internal(current_menu, most_used);
+            drawn_menu       = current_menu;
+            drawn_page       = current_menu->current_page;
+            drawn_generation = current_menu->generation;
+        }
+
+        /* Determine total pages for current menu (do this after a potential menu update) */
+        total_pages = TOTAL_PAGES(current_menu->menu_length);
+
+        /* The page is composed as one frame, the option bar below closes it (scripts skip drawing pages). An unchanged
+         * page is still in view, only full screen mode composes it again, which sends nothing to the terminal. Keys
+         * typed ahead are applied without drawing anything, only the page they leave us on is drawn. */
+        shown       = shown && !redraw;
+        typed_ahead = console_typeahead_pending_internal();
+        if (!script_file && !typed_ahead)
+        {
+            console_screen_begin_internal();
+            if (!shown || console_settings->full_screen)
+            {
+                console_print_menu_page_internal(current_menu, page_items, num_selections, most_used, num_most_used);
+            }
+            shown = true;
+        }
+        selection = console_get_response_internal(menu_options, SELECTION_SIZE(menu_options), num_selections, num_most_used, typed_ahead ? OPTIONS_QUIET : 0);
+
+        /* A digit picks from this page, a capital from the most used and 'g' asks for the item's number in the menu */
+        selected_item = NULL;
+        if ((unsigned int)(selection - '0') < num_selections)
+        {
+            selected_item = &page_items[selection - '0'];
+        }
+        else if ((unsigned int)(selection - 'A') < num_most_used)
+        {
+            selected_item = &current_menu->menu_items[most_used[selection - 'A']];
+        }
+        else if (selection == 'g')
+        {
+            selected_item = console_menu_goto_internal(current_menu, &page_items, &num_selections);
+            if (!selected_item)
+            {
+                /* Cancelled or there's no such item (the go-to prompt has said so), back to the menu */
+                continue;
+            }
+        }
+
+        /* Search results are copies of the searched menu's items, what gets used is the item a result came from. The
+         * copy's count follows along for the results' own most used section. */
+        if (selected_item && (current_menu == &search_results_menu))
+        {
+            size_t result_index = (size_t)(selected_item - search_results_items);
+
+            search_results_items[result_index].use_count++;
+            selected_item = search_results_sources[result_index];
+        }
+
+        /* First check if it's a menu selection (selection should be valid) */
+        if (selected_item)
+        {
+            selected_item->use_count++;
+
+            /* A virtual menu's page can be refetched by the function, hold on to our own copy */
+            if (current_menu->mode == MENU_VIRTUAL)
+            {
+                virtual_item  = *selected_item;
+                selected_item = &virtual_item;
+            }
+
+            /* Error out if we have neither */
+            if ((selected_item->function_pointer == NO_FUNCTION_POINTER) && (selected_item->sub_menu == NO_SUB_MENU))
+            {
+                console_print(LOGGING_LEVEL_0, ANSI_COLOR_RED " No submenu or function pointer!!!" ANSI_COLOR_RESET);
+                // for (;;);
+            }
+
+            /**
+             * Note:    A menu item can have both a submenu as well as a function pointer.
+             *          Useful if a function needs to be called prior to entering a new menu.
+             * Check if we have a function pointer
+             */
+            if (selected_item->function_pointer != NO_FUNCTION_POINTER)
+            {
+                /* In full screen mode nothing was printed after the prompt, start the function's output on a new line */
+                if (console_settings->full_screen)
+                {
+                    console_print_new_line(LOGGING_LEVEL_0);
+                }
+                /* ToDo: Handle arguments. */
+                if (MENU_MUTABLE)
+                {
+                    /**
+                     * Pass menu name to first argument of function if menu is mutable
+                     * ToDo: Either insert name at beginning or the end of the argument list when arguments are supported
+                     */
+                    char_pointer = selected_item->id.name;
+                    result       = selected_item->function_pointer(1, &char_pointer);
+                }
+                else
+                {
+                    result = selected_item->function_pointer(NO_ARGS, NO_ARGS);
+                }
+                /* We stay put after executing a function */
+                /* ToDo: Print function return status */
+                function_called = true;
+                if (script_file)
+                {
+                    console_script_report_internal(current_menu, selected_item, result);
+                }
+            }
+
+            /* Check if we have a submenu */
+            if (selected_item->sub_menu != NO_SUB_MENU)
+            {
+                current_menu = selected_item->sub_menu;
+                /* Note! After this point, we've changed menus */
+            }
+        }
+        /* Check if we're traversing up */
+        else if (selection == 'b')
+        {
+            /* Go up if we can */
+            if (current_menu->parent_menu != NO_MAIN_MENU)
+            {
+                /* Reset page */
+                current_menu->current_page = 0;
+                current_menu               = current_menu->parent_menu;
+            }
+        }
+        /* Check if we're traversing to top */
+        else if (selection == 'm')
+        {
+            /* Go up until we hit top menu */
+            while (current_menu->parent_menu != NO_MAIN_MENU)
+            {
+                /* Reset page */
+                current_menu->current_page = 0;
+                current_menu               = current_menu->parent_menu;
+            };
+        }
+        /* Check if we're going to the previous page */
+        else if (selection == 'p')
+        {
+            /* Only valid if we have more than one page and we aren't on the first page */
+            if ((total_pages > 1) && (current_menu->current_page > 0))
+            {
+                current_menu->current_page--;
+            }
+        }
+        /* Check if we're going to the next page */
+        else if (selection == 'n')
+        {
+            /* Only valid if we have more than one page and we aren't on the last page */
+            if ((total_pages > 1) && (current_menu->current_page < (total_pages - 1)))
+            {
+                current_menu->current_page++;
+            }
+        }
+        /* Check if we're searching, the results are shown as a menu of their own */
+        else if (selection == '/')
+        {
+            ConsoleMenu_t *results_menu = console_menu_search_interactive_internal(current_menu);
+
+            if (results_menu)
+            {
+                current_menu = results_menu;
+            }
+        }
+        /* Check if we're quitting */
+        else if (selection == 'q')
+        {
+            stay_put = false;
+        }
+        else
+        {
+            console_print(LOGGING_LEVEL_0, ANSI_COLOR_RED " Something went wrong..." ANSI_COLOR_RESET);
+            for (;;)
+                ;
+        }
+    } while (stay_put);
+}
+
+/**
+ * @brief   Draw the option bar and selection prompt for console_print_options_and_get_response().
+ *
+ * @param selections            The selections to list
+ * @param num_selections        The number of selections
+ * @param num_menu_selections   The number of numbered menu items, 0 for none
+ * @param num_most_used         The number of most used items, selected from 'A', 0 for none
+ * @param option_flags          NO_DIVIDERS and/or ORIENTATION_V
+ */
+static void console_print_options_internal(const ConsoleSelection_t selections[], unsigned int num_selections, unsigned int num_menu_selections, unsigned int num_most_used,
+                                           unsigned int option_flags)
+{
+    if (!(option_flags & NO_DIVIDERS))
+    {
+        console_print_divider(LOGGING_LEVEL_0);
+    }
+    else
+    {
+        console_print_new_line(LOGGING_LEVEL_0);
+    }
+    /* Print menu selections (these will override any conflicting passed in selections) */
+    if (num_menu_selections != 0)
+    {
+        console_put_string_internal(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW "0" ANSI_COLOR_RESET "-" ANSI_COLOR_YELLOW);
+        console_put_char_internal(LOGGING_LEVEL_0, (char)('0' + (num_menu_selections - 1)));
+        console_put_string_internal(LOGGING_LEVEL_0, ANSI_COLOR_RESET "]-item ");
+    }
+    if (num_most_used != 0)
+    {
+        console_put_string_internal(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW "A" ANSI_COLOR_RESET "-" ANSI_COLOR_YELLOW);
+        console_put_char_internal(LOGGING_LEVEL_0, (char)('A' + (num_most_used - 1)));
+        console_put_string_internal(LOGGING_LEVEL_0, ANSI_COLOR_RESET "]-most used ");
+    }
+    /* Print passed in selections */
+    for (unsigned int i = 0; i < num_selections; i++)
+    {
+        console_put_string_internal(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW);
+        console_put_char_internal(LOGGING_LEVEL_0, selections[i].key);
+        console_put_string_internal(LOGGING_LEVEL_0, ANSI_COLOR_RESET "]-");
+        console_put_string_internal(LOGGING_LEVEL_0, selections[i].description);
+        console_put_char_internal(LOGGING_LEVEL_0, ' ');
+        if ((option_flags & ORIENTATION_V) && !(i == (num_selections - 1)))
+        {
+            console_print_new_line(LOGGING_LEVEL_0);
+        }
+    }
+    console_print_new_line(LOGGING_LEVEL_0);
+    if (!(option_flags & NO_DIVIDERS))
+    {
+        console_print_divider(LOGGING_LEVEL_0);
+    }
+    else
+    {
+        console_print_new_line(LOGGING_LEVEL_0);
+    }
+    console_put_string_internal(LOGGING_LEVEL_0, " Selection > ");
+}
+
+char console_print_options_and_get_response(const ConsoleSelection_t selections[], unsigned int num_selections, unsigned int num_menu_selections, unsigned int option_flags)
+{
+    return console_get_response_internal(selections, num_selections, num_menu_selections, 0, option_flags);
+}
+
+/**
+ * @brief   console_print_options_and_get_response() with a most used section, whose items are selected from 'A'.
+ */
+static char console_get_response_internal(const ConsoleSelection_t selections[], unsigned int num_selections, unsigned int num_menu_selections, unsigned int num_most_used,
+                                          unsigned int option_flags)
+{
+    /* ToDo: Assert on number of menu selections greater than 10 */
+    char c;
+    bool valid        = false;
+    bool differential = frame_differential; /* The page is being redrawn in place, keep the screen as drawn */
+    bool rendered     = false;
+    bool quiet        = script_file || (option_flags & OPTIONS_QUIET);
+
+    do
+    {
+        /* Closes any frame the caller opened for the rest of the page, so the whole page goes out in one write */
+        if (!(differential && rendered) && !quiet)
+        {
+            console_frame_begin();
+            console_print_options_internal(selections, num_selections, num_menu_selections, num_most_used, option_flags);
+            console_frame_end();
+            rendered = true;
+        }
+        /* Enter, space and backspace only mean something while searching */
+        do
+        {
+            c = console_check_for_key_blocking();
+        } while (!isgraph((unsigned char)c));
+
+        /* If we have menu selections, check for those first */
+        if (num_menu_selections != 0)
+        {
+            /* Check if it's a valid menu selection */
+            if ((unsigned int)(c - '0') < num_menu_selections)
+            {
+                valid = true;
+            }
+        }
+
+        /* Then the most used items */
+        if ((unsigned int)(c - 'A') < num_most_used)
+        {
+            valid = true;
+        }
+
+        /* We didn't get a valid value yet */
+        if (!valid)
+        {
+            for (unsigned int i = 0; i < num_selections; i++)
+            {
+                if (c == selections[i].key)
+                {
+                    valid = true;
+                    break;
+                }
+            }
+        }
+
+        if (!valid && script_file)
+        {
+            script_num_bad_keys++;
+            console_print_error(LOGGING_LEVEL_0, "Script key %u: Bad selection %c!", script_num_keys, c);
+        }
+        else if (!valid && !differential)
+        {
+            console_print_new_line(LOGGING_LEVEL_0);
+            console_print(LOGGING_LEVEL_0, "Bad selection %c! ", c);
+        }
+    } while (!valid);
+
+    if (!differential && !quiet)
+    {
+        console_print(LOGGING_LEVEL_0, ANSI_COLOR_GREEN " Selecting %c!" ANSI_COLOR_RESET, c);
+        if (!(option_flags & NO_DIVIDERS))
+        {
+            console_print_divider(LOGGING_LEVEL_0);
+        }
+    }
+
+    return c;
+}
+
+void console_print(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_put_string_internal(logging_level, string_buffer);
+    console_print_new_line(logging_level);
+}
+
+void console_print_in_place(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_put_string_internal(logging_level, "\33[2K"); /* Clear out the line*/
+    console_put_string_internal(logging_level, string_buffer);
+    console_put_char_internal(logging_level, '\r');
+    console_flush();
+}
+
+/**
+ * @brief   Reserve a region of lines below the cursor that can be updated in place many times a second, e.g. for live
+ *          counters in a menu function. Lines and cells are only marked dirty when set, and the region is repainted at
+ *          most max_fps times a second, so a burst of updates costs one repaint. Only what changed is repainted, as a
+ *          single frame. Nothing else should print while the dashboard is open, and it should only be used from one
+ *          thread.
+ *
+ * @param dashboard         The dashboard to set up
+ * @param logging_level     The logging level for the region
+ * @param num_lines         The number of lines to reserve
+ * @param max_fps           The maximum number of repaints per second, 0 for no limit
+ * @return FunctionResult_e FR_OK, FR_INVALID for an empty region or FR_NOMEM if the lines couldn't be allocated
+ */
+FunctionResult_e console_dashboard_open(ConsoleDashboard_t *dashboard, LoggingLevel_e logging_level, unsigned int num_lines, unsigned int max_fps)
+{
+    memset(dashboard, 0, sizeof(ConsoleDashboard_t));
+    if (num_lines == 0)
+    {
+        return FR_INVALID;
+    }
+
+    dashboard->lines = (ConsoleDashboardLine_t *)calloc(num_lines, sizeof(ConsoleDashboardLine_t));
+    if (!dashboard->lines)
+    {
+        return FR_NOMEM;
+    }
+    dashboard->logging_level     = logging_level;
+    dashboard->num_lines         = num_lines;
+    dashboard->frame_interval_ns = max_fps ? (1000000000ull / max_fps) : 0;
+
+    /* Make room for the region, the cursor then waits on the line below it */
+    for (unsigned int i = 0; i < num_lines; i++)
+    {
+        console_print_new_line(logging_level);
+    }
+    console_flush();
+
+    return FR_OK;
+}
+
+/**
+ * @brief   Set the contents of a whole dashboard line, cells on the line are drawn over it.
+ *
+ * @param dashboard The dashboard
+ * @param line      The line to set (0 is the top of the region)
+ * @param format    The format string
+ */
+void console_dashboard_set_line(ConsoleDashboard_t *dashboard, unsigned int line, const char *format, ...)
+{
+    ConsoleDashboardLine_t *dashboard_line;
+    char                   *string_buffer;
+    va_list                 args;
+
+    if ((line >= dashboard->num_lines) || !console_logging_enabled(dashboard->logging_level))
+    {
+        return;
+    }
+
+    dashboard_line = &dashboard->lines[line];
+    string_buffer  = string_buffers[console_get_string_buffer_index()];
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+
+    if (strcmp(dashboard_line->text, string_buffer))
+    {
+        strcpy(dashboard_line->text, string_buffer);
+        dashboard_line->dirty = true;
+        dashboard->dirty      = true;
+    }
+
+    console_dashboard_refresh(dashboard);
+}
+
+/**
+ * @brief   Set the contents of a fixed width cell on a dashboard line. Cells are keyed by column, setting the same column
+ *          again replaces the cell. Contents are padded or cut to the width.
+ *
+ * @param dashboard The dashboard
+ * @param line      The line the cell is on (0 is the top of the region)
+ * @param column    The screen column the cell starts at (0 based)
+ * @param width     The printable width of the cell
+ * @param format    The format string
+ */
+void console_dashboard_set_cell(ConsoleDashboard_t *dashboard, unsigned int line, unsigned int column, unsigned int width, const char *format, ...)
+{
+    ConsoleDashboardLine_t *dashboard_line;
+    ConsoleDashboardCell_t *cell = NULL;
+    char                   *string_buffer;
+    va_list                 args;
+
+    if ((line >= dashboard->num_lines) || !console_logging_enabled(dashboard->logging_level))
+    {
+        return;
+    }
+
+    dashboard_line = &dashboard->lines[line];
+    for (unsigned int i = 0; i < dashboard_line->num_cells; i++)
+    {
+        if (dashboard_line->cells[i].column == column)
+        {
+            cell = &dashboard_line->cells[i];
+            break;
+        }
+    }
+    if (!cell)
+    {
+        if (dashboard_line->num_cells == DASHBOARD_MAX_CELLS)
+        {
+            return;
+        }
+        cell          = &dashboard_line->cells[dashboard_line->num_cells++];
+        cell->column  = column;
+        cell->text[0] = '\0';
+        cell->dirty   = true;
+    }
+
+    string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+
+    if (cell->dirty || (cell->width != width) || strncmp(cell->text, string_buffer, DASHBOARD_CELL_SIZE - 1))
+    {
+        strncpy(cell->text, string_buffer, DASHBOARD_CELL_SIZE - 1);
+        cell->text[DASHBOARD_CELL_SIZE - 1] = '\0';
+        cell->width                         = width;
+        cell->dirty                         = true;
+        dashboard->dirty                    = true;
+    }
+
+    console_dashboard_refresh(dashboard);
+}
+
+/**
+ * @brief   Paint a single dashboard cell at its column on the current line.
+ */
+static void console_dashboard_paint_cell_internal(LoggingLevel_e logging_level, ConsoleDashboardCell_t *cell)
+{
+    char   movement[16];
+    size_t length = strlen(cell->text);
+    size_t consumed;
+    size_t printable = console_isprint_span_len(cell->text, length, cell->width, &consumed);
+
+    snprintf(movement, sizeof(movement), "\x1b[%uG", cell->column + 1);
+    console_put_string_internal(logging_level, movement);
+    console_write_internal(logging_level, cell->text, consumed);
+    if (memchr(cell->text, '\x1b', consumed))
+    {
+        console_put_string_internal(logging_level, ANSI_COLOR_RESET);
+    }
+    console_print_padding_internal(logging_level, ' ', cell->width - printable);
+    cell->dirty = false;
+}
+
+/**
+ * @brief   Repaint whatever changed on the dashboard, unless the last repaint was less than a frame ago. Setting lines and
+ *          cells already does this, call it from the update loop as well (e.g. between console_wait_for_key() timeouts)
+ *          so the last updates of a burst make it to the screen.
+ *
+ * @param dashboard The dashboard
+ * @return true     The dashboard was repainted
+ * @return false    Nothing changed or it's too early for another frame
+ */
+bool console_dashboard_refresh(ConsoleDashboard_t *dashboard)
+{
+    uint64_t     now;
+    unsigned int row;
+    char         movement[16];
+
+    if (!dashboard->dirty || !dashboard->lines)
+    {
+        return false;
+    }
+    now = console_get_time_ns();
+    if (dashboard->last_paint_ns && ((now - dashboard->last_paint_ns) < dashboard->frame_interval_ns))
+    {
+        return false;
+    }
+
+    /* Start from the line below the region and move relative to it */
+    row = dashboard->num_lines;
+    console_frame_begin();
+    console_put_string_internal(dashboard->logging_level, "\x1b[?2026h");
+    for (unsigned int i = 0; i < dashboard->num_lines; i++)
+    {
+        ConsoleDashboardLine_t *line         = &dashboard->lines[i];
+        bool                    repaint_line = line->dirty;
+        bool                    cells_dirty  = false;
+
+        for (unsigned int j = 0; j < line->num_cells; j++)
+        {
+            cells_dirty |= line->cells[j].dirty;
+        }
+        if (!repaint_line && !cells_dirty)
+        {
+            continue;
+        }
+
+        snprintf(movement, sizeof(movement), (i < row) ? "\x1b[%uA\r" : "\x1b[%uB\r", (i < row) ? (row - i) : (i - row));
+        console_put_string_internal(dashboard->logging_level, movement);
+        row = i;
+
+        if (repaint_line)
+        {
+            console_put_string_internal(dashboard->logging_level, line->text);
+            console_put_string_internal(dashboard->logging_level, "\x1b[K");
+            line->dirty = false;
+        }
+        for (unsigned int j = 0; j < line->num_cells; j++)
+        {
+            /* Rewriting the line wiped out all of its cells */
+            if (repaint_line || line->cells[j].dirty)
+            {
+                console_dashboard_paint_cell_internal(dashboard->logging_level, &line->cells[j]);
+            }
+        }
+    }
+    if (row != dashboard->num_lines)
+    {
+        snprintf(movement, sizeof(movement), "\x1b[%uB\r", dashboard->num_lines - row);
+        console_put_string_internal(dashboard->logging_level, movement);
+    }
+    console_put_string_internal(dashboard->logging_level, "\x1b[?2026l");
+    console_frame_end();
+
+    dashboard->dirty         = false;
+    dashboard->last_paint_ns = now;
+
+    return true;
+}
+
+/**
+ * @brief   Paint any outstanding updates regardless of the frame rate and release the dashboard. The cursor is left on the
+ *          line below the region.
+ *
+ * @param dashboard The dashboard
+ */
+void console_dashboard_close(ConsoleDashboard_t *dashboard)
+{
+    dashboard->last_paint_ns = 0;
+    console_dashboard_refresh(dashboard);
+    free(dashboard->lines);
+    dashboard->lines     = NULL;
+    dashboard->num_lines = 0;
+}
+
+/**
+ * @brief   Scale a number down to at most 4 significant characters with an SI suffix.
+ *
+ * @param buffer    The string buffer to write into
+ * @param buff_size The string buffer size
+ * @param value     The value to format
+ */
+static void console_progress_si_internal(char *buffer, size_t buff_size, double value)
+{
+    static const char suffixes[] = {' ', 'k', 'M', 'G', 'T', 'P'};
+    unsigned int      suffix     = 0;
+
+    while ((value >= 1000.0) && (suffix < (sizeof(suffixes) - 1)))
+    {
+        value /= 1000.0;
+        suffix++;
+    }
+
+    if (suffix == 0)
+    {
+        snprintf(buffer, buff_size, "%.0f", value);
+    }
+    else
+    {
+        snprintf(buffer, buff_size, "%.*f%c", (value < 10.0) ? 2 : ((value < 100.0) ? 1 : 0), value, suffixes[suffix]);
+    }
+}
+
+/**
+ * @brief   Draw the progress meter over the current line.
+ *
+ * @param progress  The progress meter
+ * @param now       The current time in nanoseconds
+ */
+static void console_progress_render_internal(ConsoleProgress_t *progress, uint64_t now)
+{
+    const unsigned int bar_width = 30;
+    uint64_t           count     = atomic_load_explicit(&progress->count, memory_order_relaxed);
+    double             elapsed   = (double)(now - progress->start_ns) / 1e9;
+    double             interval  = (double)(now - progress->last_render_ns) / 1e9;
+    char              *line      = string_buffers[console_get_string_buffer_index()];
+    char               count_string[16];
+    char               rate_string[16];
+    size_t             length;
+
+    /* Rate over the last interval, smoothed so it doesn't jump around */
+    if (interval > 0.0)
+    {
+        double rate    = (double)(count - progress->last_count) / interval;
+        progress->rate = (progress->last_count || (progress->rate > 0.0)) ? ((0.7 * progress->rate) + (0.3 * rate)) : rate;
+    }
+    progress->last_count     = count;
+    progress->last_render_ns = now;
+
+    console_progress_si_internal(count_string, sizeof(count_string), (double)count);
+    console_progress_si_internal(rate_string, sizeof(rate_string), progress->rate);
+
+    console_put_string_internal(progress->logging_level, "\33[2K "); /* Clear out the line */
+    console_put_string_internal(progress->logging_level, progress->label);
+    console_put_char_internal(progress->logging_level, ' ');
+    if (progress->total)
+    {
+        double       fraction = (count >= progress->total) ? 1.0 : ((double)count / (double)progress->total);
+        unsigned int filled   = (unsigned int)(fraction * bar_width);
+        double       eta      = (progress->rate > 0.0) ? ((double)(progress->total - ((count > progress->total) ? progress->total : count)) / progress->rate) : 0.0;
+
+        console_put_char_internal(progress->logging_level, '[');
+        console_put_string_internal(progress->logging_level, ANSI_COLOR_GREEN);
+        for (unsigned int i = 0; i < filled; i++)
+        {
+            console_put_char_internal(progress->logging_level, '#');
+        }
+        console_put_string_internal(progress->logging_level, ANSI_COLOR_RESET);
+        console_print_padding_internal(progress->logging_level, '.', bar_width - filled);
+        length = (size_t)snprintf(line, STRING_BUFFER_SIZE, "] %5.1f%% %s %s/s ETA %02u:%02u:%02u", fraction * 100.0, count_string, rate_string,
+                                  (unsigned int)(eta / 3600.0), ((unsigned int)eta / 60) % 60, (unsigned int)eta % 60);
+    }
+    else
+    {
+        length = (size_t)snprintf(line, STRING_BUFFER_SIZE, "%s %s/s %.1fs", count_string, rate_string, elapsed);
+    }
+    console_write_internal(progress->logging_level, line, (length < STRING_BUFFER_SIZE) ? length : (STRING_BUFFER_SIZE - 1));
+    console_put_char_internal(progress->logging_level, '\r');
+    console_flush();
+}
+
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+/**
+ * @brief   Helper thread that redraws a progress meter every interval until it's finished.
+ */
+static void *console_progress_thread_internal(void *arg)
+{
+    ConsoleProgress_t *progress = (ConsoleProgress_t *)arg;
+    struct timespec    interval = {(time_t)(progress->interval_ns / 1000000000ull), (long)(progress->interval_ns % 1000000000ull)};
+
+    while (!atomic_load(&progress->stop))
+    {
+        nanosleep(&interval, NULL);
+        if (!atomic_load(&progress->stop))
+        {
+            console_progress_render_internal(progress, console_get_time_ns());
+        }
+    }
+
+    return NULL;
+}
+#endif /* defined(CONSOLE_ASYNC_SUPPORTED) */
+
+/**
+ * @brief   Start a progress and throughput meter. The work loop only calls console_progress_add(), a relaxed atomic
+ *          increment, the percentage, rate and ETA are drawn in place every interval_ms. That happens either on a helper
+ *          thread, or whenever the work loop calls console_progress_poll(), which only reads the clock until an interval
+ *          has gone by. Nothing else should print on the same terminal until the meter is finished.
+ *
+ * @param logging_level         The logging level for the meter
+ * @param label                 What's being counted, must stay valid until console_progress_finish()
+ * @param total                 The count at completion, 0 if unknown (only the count and rate are shown)
+ * @param interval_ms           How often to redraw the meter
+ * @param use_thread            Redraw from a helper thread, falls back to console_progress_poll() where there are no threads
+ * @return ConsoleProgress_t*   The progress meter, NULL if it couldn't be allocated
+ */
+ConsoleProgress_t *console_progress_start(LoggingLevel_e logging_level, const char *label, uint64_t total, unsigned int interval_ms, bool use_thread)
+{
+    ConsoleProgress_t *progress = (ConsoleProgress_t *)calloc(1, sizeof(ConsoleProgress_t));
+
+    if (!progress)
+    {
+        return NULL;
+    }
+
+    atomic_init(&progress->count, 0);
+    atomic_init(&progress->stop, false);
+    progress->logging_level  = logging_level;
+    progress->label          = label;
+    progress->total          = total;
+    progress->interval_ns    = (uint64_t)(interval_ms ? interval_ms : 1) * 1000000;
+    progress->start_ns       = console_get_time_ns();
+    progress->last_render_ns = progress->start_ns;
+
+    if (!console_logging_enabled(logging_level))
+    {
+        return progress;
+    }
+
+    console_progress_render_internal(progress, progress->start_ns);
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+    if (use_thread)
+    {
+        progress->has_thread = (pthread_create(&progress->thread, NULL, console_progress_thread_internal, progress) == 0);
+    }
+#else
+    IGNORE_UNUSED_ARG(use_thread);
+#endif /* defined(CONSOLE_ASYNC_SUPPORTED) */
+
+    return progress;
+}
+
+/**
+ * @brief   Count work done, this is all the hot loop pays for.
+ *
+ * @param progress  The progress meter
+ * @param amount    The amount of work done since the last call
+ */
+void console_progress_add(ConsoleProgress_t *progress, uint64_t amount) { atomic_fetch_add_explicit(&progress->count, amount, memory_order_relaxed); }
+
+/**
+ * @brief   Redraw the progress meter if an interval has gone by since the last time. Cheap enough to call from the work
+ *          loop, does nothing when a helper thread does the drawing.
+ *
+ * @param progress  The progress meter
+ * @return true     The meter was redrawn
+ * @return false    It's not time yet
+ */
+bool console_progress_poll(ConsoleProgress_t *progress)
+{
+    uint64_t now;
+
+    if (progress->has_thread || !console_logging_enabled(progress->logging_level))
+    {
+        return false;
+    }
+
+    now = console_get_time_ns();
+    if ((now - progress->last_render_ns) < progress->interval_ns)
+    {
+        return false;
+    }
+
+    console_progress_render_internal(progress, now);
+    return true;
+}
+
+/**
+ * @brief   Stop the helper thread if there is one, draw the meter one last time, move to the next line and free it.
+ *
+ * @param progress  The progress meter
+ */
+void console_progress_finish(ConsoleProgress_t *progress)
+{
+    if (!progress)
+    {
+        return;
+    }
+
+    atomic_store(&progress->stop, true);
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+    if (progress->has_thread)
+    {
+        pthread_join(progress->thread, NULL);
+    }
+#endif /* defined(CONSOLE_ASYNC_SUPPORTED) */
+
+    if (console_logging_enabled(progress->logging_level))
+    {
+        console_progress_render_internal(progress, console_get_time_ns());
+        console_print_new_line(progress->logging_level);
+        console_flush();
+    }
+    free(progress);
+}
+
+void console_print_block(LoggingLevel_e logging_level, const char *block_string)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    size_t total_string_len      = strlen(block_string);
+    size_t line_start            = 0;
+    size_t line_end              = 0;
+    size_t line_end_space        = 0;
+    size_t printable_line_length = 0;
+
+    while (line_start < total_string_len)
+    {
+        /* Extract a line up to TEXT_BLOCK_SIZE of printable characters (ANSI escape sequences are ignored) */
+        printable_line_length = console_isprint_span_len(&block_string[line_start], total_string_len - line_start, TEXT_BLOCK_SIZE, &line_end);
+        line_end += line_start;
+
+        /* Step back until we find a space  and we haven't lapped the line_start.*/
+        if (printable_line_length >= TEXT_BLOCK_SIZE)
+        {
+            line_end_space = line_end;
+            while ((block_string[line_end_space] != ' ') && (line_end_space > line_start))
+            {
+                line_end_space--;
+            }
+
+            /* If we find a space, print up to that space. */
+            if (line_end_space != line_start)
+            {
+                line_end = line_end_space;
+            }
+        }
+
+        /* Print from line_start to line_end (add a character margin) */
+        console_put_char_internal(logging_level, ' ');
+        console_write_internal(logging_level, &block_string[line_start], line_end - line_start);
+        console_put_char_internal(logging_level, '\n');
+
+        /* New line */
+        line_start = line_end + 1;
+    }
+}
+
+void console_print_color(LoggingLevel_e logging_level, const char *color_string, const char *inner_string)
+{
+    console_put_string_internal(logging_level, color_string);
+    console_put_string_internal(logging_level, inner_string);
+    console_put_string_internal(logging_level, ANSI_COLOR_RESET);
+    console_print_new_line(logging_level);
+}
+
+void console_print_color_no_eol(LoggingLevel_e logging_level, const char *color_string, const char *inner_string)
+{
+    console_put_string_internal(logging_level, color_string);
+    console_put_string_internal(logging_level, inner_string);
+    console_put_string_internal(logging_level, ANSI_COLOR_RESET);
+}
+
+void console_print_debug(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_print_color(logging_level, ANSI_COLOR_MAGENTA, string_buffer);
+}
+
+void console_print_debug_no_eol(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_print_color_no_eol(logging_level, ANSI_COLOR_MAGENTA, string_buffer);
+}
+
+void console_print_debug_new_line(LoggingLevel_e logging_level)
+{
+    console_put_string_internal(logging_level, "\r\n");
+}
+
+void console_print_error(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_print_color(logging_level, ANSI_COLOR_RED, string_buffer);
+}
+
+void console_print_warn(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_print_color(logging_level, ANSI_COLOR_YELLOW, string_buffer);
+}
+
+void console_print_success(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_print_color(logging_level, ANSI_COLOR_GREEN, string_buffer);
+}
+
+void console_print_no_eol(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_put_string_internal(logging_level, string_buffer);
+}
+
+void console_print_new_line(LoggingLevel_e logging_level)
+{
+    console_put_string_internal(logging_level, "\r\n");
+}
+
+void console_print_header(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_print_header_internal(logging_level, DBL_LINE_CHAR, string_buffer);
+}
+
+void console_print_sub_header(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_print_header_internal(logging_level, SGL_LINE_CHAR, string_buffer);
+}
+
+void console_print_footer_banner(LoggingLevel_e logging_level, const char *format, ...)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
+
+    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+    va_list args;
+    va_start(args, format);
+    console_format_internal(string_buffer, format, args);
+    va_end(args);
+    console_print_divider(logging_level);
+    console_put_string_internal(logging_level, "  "); /* Add some space */
+    console_put_string_internal(logging_level, string_buffer);
+    console_print_divider(logging_level);
+}
+
+void console_print_header_internal(LoggingLevel_e logging_level, const char *ruler_string, const char *header_string)
+{
+    unsigned int is_print_string_length = console_isprint_str_len(header_string);
+
+    if (is_print_string_length > MAX_HEADER_TITLE_WIDTH)
+    {
+        is_print_string_length = MAX_HEADER_TITLE_WIDTH;
+    }
+    console_print_new_line(logging_level);
+    console_put_string_internal(logging_level, ruler_string);
+    console_put_string_internal(logging_level, "[" ANSI_COLOR_YELLOW " ");
+    console_put_string_internal(logging_level, header_string);
+    console_put_string_internal(logging_level, " " ANSI_COLOR_RESET "]");
+    console_put_string_internal(logging_level, ruler_string);
+    if (!console_settings->small_headers)
+    {
+        /* The ruler is drawn from a precomputed span rather than one character at a time */
+        console_print_padding_internal(logging_level, ruler_string[0], CONSOLE_WIDTH - is_print_string_length - HEADER_TITLE_EXTRAS_WIDTH);
+    }
+    console_print_new_line(logging_level);
+    console_print_new_line(logging_level);
+}
+
+void console_print_divider(LoggingLevel_e logging_level)
+{
+    console_print_padding_internal(logging_level, SGL_LINE_CHAR[0], CONSOLE_WIDTH);
+    console_print_new_line(logging_level);
+}
+
+/**
+ * @brief   Get the items on a menu's current page. A virtual menu's page provider is only asked for this page's items,
+ *          which also brings its total up to date (a page past a shrunken end moves back to the last page), every other
+ *          menu already holds all of its items.
+ *
+ * @param menu                  The menu
+ * @param num_items             Set to the number of items on the page
+ * @return ConsoleMenuItem_t*   The first item on the page
+ */
+static ConsoleMenuItem_t *console_menu_get_page_internal(ConsoleMenu_t *menu, unsigned int *num_items)
+{
+    unsigned int offset = menu->current_page * PAGE_LENGTH;
+
+    if (menu->mode == MENU_VIRTUAL)
+    {
+        /* ToDo: Assert on null pointer. */
+        menu->menu_length = menu->page_provider(menu, menu_page_items, offset, PAGE_LENGTH);
+        if (offset && (offset >= menu->menu_length))
+        {
+            menu->current_page = menu->menu_length ? (TOTAL_PAGES(menu->menu_length) - 1) : FIRST_PAGE;
+            offset             = menu->current_page * PAGE_LENGTH;
+            menu->menu_length  = menu->page_provider(menu, menu_page_items, offset, PAGE_LENGTH);
+        }
+    }
+
+    if (offset >= menu->menu_length)
+    {
+        *num_items = 0;
+    }
+    else
+    {
+        *num_items = ((menu->menu_length - offset) > PAGE_LENGTH) ? PAGE_LENGTH : (menu->menu_length - offset);
+    }
+
+    return (menu->mode == MENU_VIRTUAL) ? menu_page_items : &menu->menu_items[offset];
+}
+
+void console_print_menu(ConsoleMenu_t *menu)
+{
+    unsigned int       num_items;
+    ConsoleMenuItem_t *page_items = console_menu_get_page_internal(menu, &num_items);
+    unsigned int       most_used[MENU_MOST_USED_MAX];
+    unsigned int       num_most_used = console_menu_most_used_internal(menu, most_used);
+
+    console_print_menu_page_internal(menu, page_items, num_items, most_used, num_most_used);
+}
+
+/**
+ * @brief   Print a menu page, header and breadcrumbs included.
+ *
+ * @param menu          The menu
+ * @param page_items    The items on the current page, see console_menu_get_page_internal()
+ * @param num_items     The number of items on the current page
+ * @param most_used     The indices of the menu's most used items, see console_menu_most_used_internal()
+ * @param num_most_used The number of most used items
+ */
+static void console_print_menu_page_internal(ConsoleMenu_t *menu, ConsoleMenuItem_t *page_items, unsigned int num_items, const unsigned int most_used[],
+                                             unsigned int num_most_used)
+{
+    unsigned int total_pages = TOTAL_PAGES(menu->menu_length);
+    const char   menu_breadcrumb_separator[]                               = BREADCRUMB_SEPARATOR;
+    char         menu_breadcrumb_string[MAX_MENU_DESCRIPTION_LENGTH + 100] = {0}; /* Adding a bit of breathing room for the breadcrumb to move */
+
+    /* Make breadcrumbs */
+    ConsoleMenu_t *menu_breadcrumb = menu;
+    snprintf(menu_breadcrumb_string, sizeof(menu_breadcrumb_string), "%s" ANSI_COLOR_RESET, menu_breadcrumb->id.name);
+    do
+    {
+        /* Go up a level */
+        menu_breadcrumb = menu_breadcrumb->parent_menu;
+        if (menu_breadcrumb)
+        {
+            size_t parent_menu_name_length = strlen(menu_breadcrumb->id.name);
+            size_t separator_length        = strlen(menu_breadcrumb_separator);
+            memmove(menu_breadcrumb_string + parent_menu_name_length + separator_length, menu_breadcrumb_string, strlen(menu_breadcrumb_string));
+            strncpy(menu_breadcrumb_string, menu_breadcrumb->id.name, parent_menu_name_length);
+            strncpy(menu_breadcrumb_string + parent_menu_name_length, menu_breadcrumb_separator, strlen(menu_breadcrumb_separator));
+        }
+    } while (menu_breadcrumb);
+
+    console_print_header_internal(LOGGING_LEVEL_0, DBL_LINE_CHAR, menu_breadcrumb_string);
+    console_put_char_internal(LOGGING_LEVEL_0, ' ');
+    console_put_string_internal(LOGGING_LEVEL_0, menu->id.description);
+
+    if (total_pages > 1)
+    {
+        unsigned int first_item = menu->current_page * PAGE_LENGTH;
+
+        console_print(LOGGING_LEVEL_0, " - Page (%i/%i), items %u-%u", menu->current_page + 1, total_pages, first_item, first_item + num_items - 1);
+    }
+    else
+    {
+        console_print_new_line(LOGGING_LEVEL_0);
+    }
+
+    if (num_most_used)
+    {
+        console_print_new_line(LOGGING_LEVEL_0);
+        for (unsigned int i = 0; i < num_most_used; i++)
+        {
+            ConsoleMenuItem_t *menu_item = &menu->menu_items[most_used[i]];
+            console_put_string_internal(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW);
+            console_put_char_internal(LOGGING_LEVEL_0, (char)('A' + i));
+            console_put_string_internal(LOGGING_LEVEL_0, ANSI_COLOR_RESET "] ");
+            console_print(LOGGING_LEVEL_0, "%s (item %u, used: %u)", menu_item->id.name, most_used[i], menu_item->use_count);
+        }
+    }
+
+    if (menu->menu_length)
+    {
+        /* Space above the menu options */
+        console_print_new_line(LOGGING_LEVEL_0);
+        /**
+         * If we have multiple pages and we aren't on the first page, indicate
+         * to the user that they can go to the previous page
+         */
+        if ((total_pages > 1) && (menu->current_page > 0))
+        {
+            console_put_string_internal(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW "p" ANSI_COLOR_RESET "] <<< Prev Page");
+            console_print_new_line(LOGGING_LEVEL_0);
+        }
+        for (unsigned int i = 0; i < num_items; i++)
+        {
+            ConsoleMenuItem_t *menu_item = &page_items[i];
+            console_put_string_internal(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW);
+            console_put_char_internal(LOGGING_LEVEL_0, (char)('0' + i));
+            console_put_string_internal(LOGGING_LEVEL_0, ANSI_COLOR_RESET "] ");
+            console_put_string_internal(LOGGING_LEVEL_0, menu_item->id.name);
+            if (menu_item->id.description[0] != '\0')
+            {
+                console_put_string_internal(LOGGING_LEVEL_0, " - ");
+                console_put_string_internal(LOGGING_LEVEL_0, menu_item->id.description);
+            }
+            console_print_new_line(LOGGING_LEVEL_0);
+        }
+        /**
+         * If we have multiple pages and we aren't on the first page, indicate
+         * to the user that they can go to the next page
+         */
+        if ((total_pages > 1) && (menu->current_page < (total_pages - 1)))
+        {
+            console_put_string_internal(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW "n" ANSI_COLOR_RESET "] >>> Next Page");
+            console_print_new_line(LOGGING_LEVEL_0);
+        }
+        /* Space below the menu options */
+        console_print_new_line(LOGGING_LEVEL_0);
+    }
+    else
+    {
+        console_print_new_line(LOGGING_LEVEL_0);
+        console_print_warn(LOGGING_LEVEL_0, " <empty like your cup of coffee>");
+        console_print_new_line(LOGGING_LEVEL_0);
+    }
+}
+
+unsigned int console_get_string_buffer_index()
+{
+
+    unsigned int returned_string_buffer_index = current_string_buffer_index;
+
+    if (++current_string_buffer_index >= NUM_STRING_BUFFERS)
+    {
+        current_string_buffer_index = 0;
+    };
+
+    return returned_string_buffer_index;
+}
+
+LoggingLevel_e console_get_logging_level()
+{
+    return console_settings->logging_level;
+}
+
+/**
+ * @brief   Check if output at a logging level would be printed. Printers call this before doing any formatting work so
+ *          that filtered messages cost next to nothing.
+ *
+ * @param logging_level The logging level to check
+ * @return true         Output at this logging level is printed
+ * @return false        Output at this logging level is filtered
+ */
+bool console_logging_enabled(LoggingLevel_e logging_level)
+{
+    return (console_settings->logging_level >= logging_level);
+}
+
+/**
+ * @brief   Hand everything in the calling thread's output buffer to the sink. This happens automatically when the buffer
+ *          fills up, before any input is read (so prompts are always visible), and at exit. Threads other than the console
+ *          thread also flush at the end of every line, but should call this before exiting if they printed a partial line.
+ */
+void console_flush(void)
+{
+    if (frame_spill_length)
+    {
+        /* Whatever spilled out of the output buffer during a frame goes out together with the rest of it, or just ahead
+         * of it if the spill buffer can't grow */
+        bool appended = console_frame_spill_internal();
+
+        console_emit_internal(frame_spill, frame_spill_length);
+        frame_spill_length = 0;
+        if (!appended && output_buffer_length)
+        {
+            console_emit_internal(output_buffer, output_buffer_length);
+        }
+    }
+    else if (output_buffer_length)
+    {
+        console_emit_internal(output_buffer, output_buffer_length);
+    }
+
+    output_buffer_length = 0;
+}
+
+/**
+ * @brief   Hand a span to the asynchronous writer or the sink, and count it towards the frame statistics.
+ *
+ * @param data      The bytes to write, data[length] must be writable so it can be NUL terminated for put_string_fn
+ * @param length    The number of bytes to write
+ */
+static void console_emit_internal(char *data, size_t length)
+{
+    frame_stats.bytes += length;
+    frame_stats.sink_calls++;
+
+    /* Whatever this is, it's not the page we last drew */
+    if (!frame_differential)
+    {
+        atomic_store(&screen_valid, false);
+    }
+
+    /* In asynchronous mode the writer thread talks to the sink, we just queue up the lines. Each line is a message of
+     * its own so that the overflow policies keep or drop whole lines (and the escape sequences in them). */
+    atomic_fetch_add(&async_producers, 1);
+    if (atomic_load(&async_running))
+    {
+        size_t max_length = ASYNC_RECORD_SIZE * ((async_queue_mask + 1) / 2);
+
+        while (length)
+        {
+            const char *end            = (const char *)memchr(data, '\n', length);
+            size_t      message_length = end ? (size_t)(end - data) + 1 : length;
+
+            /* A line that would hog more than half the queue goes in pieces */
+            if (message_length > max_length)
+            {
+                message_length = max_length;
+            }
+            console_async_push_internal(data, message_length);
+            data += message_length;
+            length -= message_length;
+        }
+    }
+    else
+    {
+        console_sink_write_internal(data, length);
+    }
+    atomic_fetch_sub(&async_producers, 1);
+}
+
+/**
+ * @brief   Move the output buffer onto the end of the frame spill buffer, growing it as needed.
+ *
+ * @return true     The output buffer is now empty
+ * @return false    The spill buffer couldn't grow, nothing was moved
+ */
+static bool console_frame_spill_internal(void)
+{
+    size_t needed = frame_spill_length + output_buffer_length + 1; /* +1 to NUL terminate for put_string_fn */
+
+    if (needed > frame_spill_size)
+    {
+        size_t new_size  = frame_spill_size ? frame_spill_size : (OUTPUT_BUFFER_SIZE * 2);
+        char  *new_spill = NULL;
+
+        while (new_size < needed)
+        {
+            new_size *= 2;
+        }
+        new_spill = (char *)realloc(frame_spill, new_size);
+        if (!new_spill)
+        {
+            return false;
+        }
+        frame_spill      = new_spill;
+        frame_spill_size = new_size;
+    }
+
+    memcpy(&frame_spill[frame_spill_length], output_buffer, output_buffer_length);
+    frame_spill_length += output_buffer_length;
+    output_buffer_length = 0;
+
+    return true;
+}
+
+/**
+ * @brief   Start composing a frame. Everything the calling thread prints until console_frame_end() is held back and
+ *          handed to the sink in a single write, however large it gets. Frames don't nest, beginning a frame while one is
+ *          open just carries on with the open one. Reading input still flushes, so prompts are always visible.
+ */
+void console_frame_begin(void)
+{
+    if (frame_open)
+    {
+        return;
+    }
+
+    frame_open = true;
+    memset(&frame_stats, 0, sizeof(frame_stats));
+}
+
+/**
+ * @brief   Finish the open frame and write it out, its cost is then available from console_get_frame_stats().
+ */
+void console_frame_end(void)
+{
+    if (!frame_open)
+    {
+        return;
+    }
+
+    if (frame_differential)
+    {
+        console_screen_redraw_internal();
+    }
+    else
+    {
+        console_flush();
+    }
+    frame_open       = false;
+    frame_stats_last = frame_stats;
+}
+
+/**
+ * @brief   Get the cost of the calling thread's last completed frame.
+ *
+ * @param stats Where to copy the bytes written, sink calls and format calls of the frame
+ */
+void console_get_frame_stats(ConsoleFrameStats_t *stats) { *stats = frame_stats_last; }
+
+/**
+ * @brief   Check whether stdout is a terminal we can redraw in place: a tty that isn't a dumb terminal and is at least
+ *          CONSOLE_WIDTH wide (wrapped lines would throw off the cursor movements). Without a way to tell on other
+ *          platforms, the full_screen setting is taken at its word.
+ */
+static bool console_terminal_capable_internal(void)
+{
+#if defined(CONSOLE_POSIX_INPUT_SUPPORTED)
+    const char    *term = getenv("TERM");
+    struct winsize window_size;
+
+    if (!isatty(STDOUT_FILENO) || !term || !strcmp(term, "dumb"))
+    {
+        return false;
+    }
+    if ((ioctl(STDOUT_FILENO, TIOCGWINSZ, &window_size) != 0) || (window_size.ws_col < CONSOLE_WIDTH))
+    {
+        return false;
+    }
+#endif /* defined(CONSOLE_POSIX_INPUT_SUPPORTED) */
+    return true;
+}
+
+/**
+ * @brief   Check whether a page of a number of lines fits the terminal as it is now. Cursor movements stop at the top of
+ *          the screen, so redrawing a page taller than the window in place would scribble over the wrong lines. The
+ *          window size is read again every time since it can change at any moment.
+ *
+ * @param num_lines The number of lines in the page
+ * @return true     The page fits, or there's no way to tell on this platform
+ */
+static bool console_screen_fits_internal(size_t num_lines)
+{
+#if defined(CONSOLE_POSIX_INPUT_SUPPORTED)
+    struct winsize window_size;
+
+    if ((ioctl(STDOUT_FILENO, TIOCGWINSZ, &window_size) != 0) || (window_size.ws_col < CONSOLE_WIDTH) || (num_lines > window_size.ws_row))
+    {
+        return false;
+    }
+#else
+    IGNORE_UNUSED_ARG(num_lines);
+#endif /* defined(CONSOLE_POSIX_INPUT_SUPPORTED) */
+    return true;
+}
+
+/**
+ * @brief   Start a page frame that console_frame_end() draws differentially in full screen mode, or a plain frame
+ *          otherwise. Anything printed before the page goes out first so it isn't mistaken for part of it.
+ */
+static void console_screen_begin_internal(void)
+{
+    if (console_settings->full_screen && !frame_open)
+    {
+        console_flush();
+        console_frame_begin();
+        frame_differential = true;
+    }
+    else
+    {
+        console_frame_begin();
+    }
+}
+
+/**
+ * @brief   Split a page into lines, dropping the "\r\n" line endings.
+ *
+ * @param text          The page text
+ * @param length        The length of the page text
+ * @param lines         Set to the start of each line
+ * @param line_lengths  Set to the length of each line
+ * @return size_t       The number of lines, or 0 if there are more than SCREEN_MAX_LINES
+ */
+static size_t console_screen_split_internal(const char *text, size_t length, const char *lines[], size_t line_lengths[])
+{
+    size_t num_lines = 0;
+    size_t start     = 0;
+
+    for (size_t i = 0; i <= length; i++)
+    {
+        if ((i == length) || (text[i] == '\n'))
+        {
+            if (num_lines == SCREEN_MAX_LINES)
+            {
+                return 0;
+            }
+            lines[num_lines]        = &text[start];
+            line_lengths[num_lines] = ((i > start) && (text[i - 1] == '\r')) ? (i - start - 1) : (i - start);
+            num_lines++;
+            start = i + 1;
+        }
+    }
+
+    return num_lines;
+}
+
+/**
+ * @brief   Finish a differential page frame. If the screen still shows the last page, only the lines that changed are
+ *          rewritten, moving the cursor relative to the prompt line, all inside synchronized output brackets so the
+ *          terminal shows the update at once. Otherwise, or if either page is taller than the terminal, the page is
+ *          appended as usual. Either way the cursor ends up
+ *          after the prompt on the last line and the page becomes the new screen model.
+ */
+static void console_screen_redraw_internal(void)
+{
+    const char *old_lines[SCREEN_MAX_LINES];
+    const char *new_lines[SCREEN_MAX_LINES];
+    size_t      old_lengths[SCREEN_MAX_LINES];
+    size_t      new_lengths[SCREEN_MAX_LINES];
+    size_t      num_old_lines = 0;
+    size_t      num_new_lines = 0;
+    size_t      row;
+    char       *page;
+    size_t      page_length;
+    char        movement[32];
+
+    /* Take the whole page out of the frame buffers so we can write the update through them */
+    if (!console_frame_spill_internal())
+    {
+        frame_differential = false;
+        console_flush();
+        return;
+    }
+    page               = frame_spill;
+    page_length        = frame_spill_length;
+    frame_spill        = NULL;
+    frame_spill_length = 0;
+    frame_spill_size   = 0;
+
+    num_new_lines = console_screen_split_internal(page, page_length, new_lines, new_lengths);
+    if (atomic_load(&screen_valid) && screen_text)
+    {
+        num_old_lines = console_screen_split_internal(screen_text, screen_length, old_lines, old_lengths);
+    }
+
+    /* Pages that don't fit the window (either of them, the old one is where the cursor has to go back up through) are
+     * appended instead */
+    if ((num_old_lines == 0) || (num_new_lines == 0) || !console_screen_fits_internal((num_old_lines > num_new_lines) ? num_old_lines : num_new_lines))
+    {
+        console_write_internal(LOGGING_LEVEL_0, page, page_length);
+    }
+    else
+    {
+        /* The cursor sits on the old prompt line */
+        row = num_old_lines - 1;
+        console_put_string_internal(LOGGING_LEVEL_0, "\x1b[?2026h");
+        for (size_t line = 0; line < ((num_old_lines > num_new_lines) ? num_old_lines : num_new_lines); line++)
+        {
+            bool is_prompt = (line == (num_new_lines - 1));
+            bool changed   = (line >= num_old_lines) || (line >= num_new_lines) || (old_lengths[line] != new_lengths[line]) ||
+                           memcmp(old_lines[line], new_lines[line], new_lengths[line]);
+
+            /* The prompt line is always rewritten so the cursor ends up right after it */
+            if (!changed && !is_prompt)
+            {
+                continue;
+            }
+
+            if (line < row)
+            {
+                snprintf(movement, sizeof(movement), "\x1b[%zuA", row - line);
+                console_put_string_internal(LOGGING_LEVEL_0, movement);
+            }
+            for (; row < line; row++)
+            {
+                /* Moving down with new lines rather than cursor movements scrolls if we run out of screen */
+                console_put_string_internal(LOGGING_LEVEL_0, "\r\n");
+            }
+            row = line;
+
+            console_put_char_internal(LOGGING_LEVEL_0, '\r');
+            if (line < num_new_lines)
+            {
+                console_write_internal(LOGGING_LEVEL_0, new_lines[line], new_lengths[line]);
+            }
+            console_put_string_internal(LOGGING_LEVEL_0, "\x1b[K");
+        }
+
+        /* Leave the cursor after the prompt if the page got shorter */
+        if (row != (num_new_lines - 1))
+        {
+            snprintf(movement, sizeof(movement), "\x1b[%zuA\r", row - (num_new_lines - 1));
+            console_put_string_internal(LOGGING_LEVEL_0, movement);
+            console_write_internal(LOGGING_LEVEL_0, new_lines[num_new_lines - 1], new_lengths[num_new_lines - 1]);
+        }
+        console_put_string_internal(LOGGING_LEVEL_0, "\x1b[?2026l");
+    }
+
+    console_flush();
+    frame_differential = false;
+
+    free(screen_text);
+    screen_text   = page;
+    screen_length = page_length;
+    atomic_store(&screen_valid, num_new_lines != 0);
+}
+
+/**
+ * @brief   vsnprintf() into a string buffer on behalf of the print family, counted towards the frame statistics.
+ *
+ * @param string_buffer The string buffer to format into, STRING_BUFFER_SIZE long
+ * @param format        The format string
+ * @param args          The format arguments
+ */
+static void console_format_internal(char *string_buffer, const char *format, va_list args)
+{
+    frame_stats.format_calls++;
+    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
+}
+
+/**
+ * @brief   Write bytes straight to the configured sink.
+ *
+ * @param data      The bytes to write, data[length] must be writable so it can be NUL terminated for put_string_fn
+ * @param length    The number of bytes to write
+ */
+static void console_sink_write_internal(char *data, size_t length)
+{
+    if (console_settings->write_fn)
+    {
+        console_settings->write_fn(data, length);
+    }
+    else if (console_settings->put_string_fn)
+    {
+        data[length] = '\0';
+        console_settings->put_string_fn(data);
+    }
+    else if (console_settings->put_char_fn)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            console_settings->put_char_fn(data[i]);
+        }
+    }
+}
+
+/**
+ * @brief   Flush everything the calling thread and the asynchronous writer are holding on to and stop the writer. This
+ *          is registered to run at exit and is also called before console_assert_fatal() exits.
+ */
+static void console_exit_flush_internal(void)
+{
+    console_flush();
+    console_async_stop();
+}
+
+/**
+ * @brief   Remove the oldest message from the asynchronous queue.
+ *
+ * @param buffer        Where to copy the message to (grown as needed), or NULL to discard it
+ * @param buffer_size   The size of the buffer, updated when it grows
+ * @param length        Set to the length of the message
+ * @return true         A message was removed
+ * @return false        The queue was empty (or the oldest message is still being written)
+ */
+static bool console_async_pop_internal(char **buffer, size_t *buffer_size, size_t *length)
+{
+    size_t index = atomic_load_explicit(&async_dequeue_index, memory_order_relaxed);
+
+    for (;;)
+    {
+        ConsoleAsyncRecord_t *cell       = &async_queue[index & async_queue_mask];
+        size_t                sequence   = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t              difference = (intptr_t)sequence - (intptr_t)(index + 1);
+
+        if (difference == 0)
+        {
+            /* The rest of the message was published before its first record, so it's all there */
+            size_t num_records = atomic_load_explicit(&cell->num_records, memory_order_relaxed);
+
+            if (atomic_compare_exchange_weak_explicit(&async_dequeue_index, &index, index + num_records, memory_order_relaxed, memory_order_relaxed))
             {
-                valid = true;
+                size_t message_length = 0;
+
+                for (size_t i = 0; i < num_records; i++)
+                {
+                    cell = &async_queue[(index + i) & async_queue_mask];
+                    if (buffer)
+                    {
+                        if (message_length + cell->length + 1 > *buffer_size)
+                        {
+                            size_t new_size   = (message_length + cell->length + 1) * 2;
+                            char  *new_buffer = (char *)realloc(*buffer, new_size);
+
+                            if (new_buffer)
+                            {
+                                *buffer      = new_buffer;
+                                *buffer_size = new_size;
+                            }
+                        }
+                        if (message_length + cell->length + 1 <= *buffer_size)
+                        {
+                            memcpy(&(*buffer)[message_length], cell->data, cell->length);
+                            message_length += cell->length;
+                        }
+                    }
+                    atomic_store_explicit(&cell->sequence, index + i + async_queue_mask + 1, memory_order_release);
+                }
+                *length = message_length;
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            index = atomic_load_explicit(&async_dequeue_index, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief   Try to add a message to the asynchronous queue, as a run of consecutive records that are claimed together.
+ *
+ * @param data      The bytes to queue
+ * @param length    The number of bytes, at most half the queue's worth of records
+ * @return true     The message was queued
+ * @return false    The queue doesn't have room for it
+ */
+static bool console_async_try_push_internal(const char *data, size_t length)
+{
+    size_t num_records = length ? (length + ASYNC_RECORD_SIZE - 1) / ASYNC_RECORD_SIZE : 1;
+    size_t index       = atomic_load_explicit(&async_enqueue_index, memory_order_relaxed);
+
+    for (;;)
+    {
+        intptr_t difference = 0;
+
+        /* Every record of the run has to be free on this lap of the queue */
+        for (size_t i = 0; (i < num_records) && (difference == 0); i++)
+        {
+            size_t sequence = atomic_load_explicit(&async_queue[(index + i) & async_queue_mask].sequence, memory_order_acquire);
+            difference      = (intptr_t)sequence - (intptr_t)(index + i);
+        }
+
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&async_enqueue_index, &index, index + num_records, memory_order_relaxed, memory_order_relaxed))
+            {
+                /* Publish the first record last, the writer takes the message as soon as it sees it */
+                for (size_t i = num_records; i-- > 0;)
+                {
+                    ConsoleAsyncRecord_t *cell = &async_queue[(index + i) & async_queue_mask];
+
+                    cell->length = (i == num_records - 1) ? length - i * ASYNC_RECORD_SIZE : ASYNC_RECORD_SIZE;
+                    memcpy(cell->data, &data[i * ASYNC_RECORD_SIZE], cell->length);
+                    atomic_store_explicit(&cell->num_records, num_records, memory_order_relaxed);
+                    atomic_store_explicit(&cell->sequence, index + i + 1, memory_order_release);
+                }
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            index = atomic_load_explicit(&async_enqueue_index, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief   Wake the asynchronous writer if it's waiting for work, called after queueing a message.
+ */
+static void console_async_wake_writer_internal(void)
+{
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+    /* Pairs with the fence in the writer between announcing it's waiting and looking at the queue one last time */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&async_writer_waiting, memory_order_relaxed))
+    {
+        pthread_mutex_lock(&async_mutex);
+        pthread_cond_signal(&async_work);
+        pthread_mutex_unlock(&async_mutex);
+    }
+#endif
+}
+
+/**
+ * @brief   Add a message to the asynchronous queue, applying the overflow policy if the queue is full, and wake the writer
+ *          if it's waiting for work.
+ *
+ * @param data      The bytes to queue
+ * @param length    The number of bytes, at most half the queue's worth of records
+ */
+static void console_async_push_internal(const char *data, size_t length)
+{
+    size_t dropped_length;
+
+    while (!console_async_try_push_internal(data, length))
+    {
+        switch (async_overflow_policy)
+        {
+            case ASYNC_OVERFLOW_DROP_NEWEST:
+                atomic_fetch_add(&async_drop_count, 1);
+                return;
+            case ASYNC_OVERFLOW_DROP_OLDEST:
+                if (console_async_pop_internal(NULL, NULL, &dropped_length))
+                {
+                    atomic_fetch_add(&async_drop_count, 1);
+                    continue;
+                }
+                /* Nothing was dropped: the oldest message is still being written by another producer, or the writer has
+                 * just emptied the queue. In the second case there's room now. */
+                if (console_async_try_push_internal(data, length))
+                {
+                    goto queued;
+                }
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+                /* Whoever is writing the oldest message won't be long */
+                sched_yield();
+#endif
+                break;
+            case ASYNC_OVERFLOW_BLOCK:
+            default:
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+                /* Sleep until the writer frees some records. The writer checks for waiters after freeing records, so
+                 * either it sees us or we see the room it made when trying again under the lock. */
+                pthread_mutex_lock(&async_mutex);
+                atomic_fetch_add(&async_space_waiters, 1);
+                atomic_thread_fence(memory_order_seq_cst);
+                while (!console_async_try_push_internal(data, length))
+                {
+                    pthread_cond_wait(&async_space, &async_mutex);
+                }
+                atomic_fetch_sub(&async_space_waiters, 1);
+                pthread_mutex_unlock(&async_mutex);
+                goto queued;
+#endif
+                break;
+        }
+    }
+
+queued:
+    console_async_wake_writer_internal();
+}
+
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+/**
+ * @brief   Check whether the next message in the asynchronous queue is ready for the writer.
+ */
+static bool console_async_ready_internal(void)
+{
+    size_t index = atomic_load_explicit(&async_dequeue_index, memory_order_relaxed);
+
+    return atomic_load_explicit(&async_queue[index & async_queue_mask].sequence, memory_order_acquire) == index + 1;
+}
+
+/**
+ * @brief   The asynchronous writer thread, drains the queue to the sink until asynchronous mode is stopped. It sleeps
+ *          while the queue is empty, producers wake it when they queue something.
+ */
+static void *console_async_writer_internal(void *arg)
+{
+    char  *message      = NULL;
+    size_t message_size = 0;
+    size_t length;
+
+    IGNORE_UNUSED_ARG(arg);
+
+    for (;;)
+    {
+        atomic_store(&async_writer_busy, true);
+        if (console_async_pop_internal(&message, &message_size, &length))
+        {
+            /* Wake producers waiting for room now that there is some */
+            atomic_thread_fence(memory_order_seq_cst);
+            if (atomic_load_explicit(&async_space_waiters, memory_order_relaxed))
+            {
+                pthread_mutex_lock(&async_mutex);
+                pthread_cond_broadcast(&async_space);
+                pthread_mutex_unlock(&async_mutex);
+            }
+            if (length)
+            {
+                console_sink_write_internal(message, length);
+            }
+            continue;
+        }
+
+        /* Nothing to do, let anyone flushing know and sleep until there's more. The fence pairs with the one producers
+         * go through after queueing, either they see us waiting or we see what they queued. */
+        pthread_mutex_lock(&async_mutex);
+        atomic_store(&async_writer_waiting, true);
+        atomic_thread_fence(memory_order_seq_cst);
+        atomic_store(&async_writer_busy, false);
+        pthread_cond_broadcast(&async_drained);
+        while (!console_async_ready_internal() && atomic_load(&async_running))
+        {
+            pthread_cond_wait(&async_work, &async_mutex);
+        }
+        atomic_store(&async_writer_waiting, false);
+        pthread_mutex_unlock(&async_mutex);
+
+        /* Only leave once we've been stopped and the queue has been drained */
+        if (!atomic_load(&async_running) && (atomic_load(&async_producers) == 0) &&
+            (atomic_load(&async_enqueue_index) == atomic_load(&async_dequeue_index)))
+        {
+            break;
+        }
+    }
+
+    free(message);
+
+    return NULL;
+}
+#endif /* defined(CONSOLE_ASYNC_SUPPORTED) */
+
+/**
+ * @brief   Start asynchronous logging. Flushed output is pushed into a bounded lock-free queue and a single background
+ *          writer thread drains it to the sink, so printing threads never block on the terminal.
+ *
+ * @param queue_length      The number of records in the queue (rounded up to a power of two)
+ * @param overflow_policy   What producers do when the queue is full
+ * @return FunctionResult_e FR_OK if asynchronous logging is running, FR_UNSUPPORTED if the platform has no threads,
+ *                          FR_NOMEM if the queue couldn't be allocated, FR_FAIL if the writer thread couldn't start
+ */
+FunctionResult_e console_async_start(unsigned int queue_length, ConsoleAsyncOverflow_e overflow_policy)
+{
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+    size_t length = 2;
+
+    if (atomic_load(&async_running))
+    {
+        return FR_BUSY;
+    }
+
+    /* Anything printed before now goes out in order, directly */
+    console_flush();
+
+    while (length < queue_length)
+    {
+        length <<= 1;
+    }
+
+    free(async_queue);
+    async_queue = (ConsoleAsyncRecord_t *)malloc(sizeof(ConsoleAsyncRecord_t) * length);
+    if (!async_queue)
+    {
+        return FR_NOMEM;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        atomic_init(&async_queue[i].sequence, i);
+    }
+    async_queue_mask      = length - 1;
+    async_overflow_policy = overflow_policy;
+    atomic_store(&async_enqueue_index, 0);
+    atomic_store(&async_dequeue_index, 0);
+    atomic_store(&async_drop_count, 0);
+    atomic_store(&async_running, true);
+
+    if (pthread_create(&async_writer_thread, NULL, console_async_writer_internal, NULL) != 0)
+    {
+        atomic_store(&async_running, false);
+        return FR_FAIL;
+    }
+
+    return FR_OK;
+#else
+    IGNORE_UNUSED_ARG(queue_length);
+    IGNORE_UNUSED_ARG(overflow_policy);
+    return FR_UNSUPPORTED;
+#endif /* defined(CONSOLE_ASYNC_SUPPORTED) */
+}
+
+/**
+ * @brief   Stop asynchronous logging. The calling thread's buffer and everything queued is written out before this
+ *          returns, afterwards output goes directly to the sink again.
+ */
+void console_async_stop(void)
+{
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+    if (!atomic_load(&async_running))
+    {
+        return;
+    }
+
+    console_flush();
+    pthread_mutex_lock(&async_mutex);
+    atomic_store(&async_running, false);
+    pthread_cond_signal(&async_work);
+    pthread_mutex_unlock(&async_mutex);
+    pthread_join(async_writer_thread, NULL);
+#endif /* defined(CONSOLE_ASYNC_SUPPORTED) */
+}
+
+/**
+ * @brief   Flush the calling thread's buffer and wait until the asynchronous writer has written everything queued so far.
+ *          Does nothing more than console_flush() when asynchronous logging isn't running.
+ */
+void console_async_flush(void)
+{
+    console_flush();
+
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+    pthread_mutex_lock(&async_mutex);
+    while (atomic_load(&async_running) && ((atomic_load(&async_enqueue_index) != atomic_load(&async_dequeue_index)) || atomic_load(&async_writer_busy)))
+    {
+        pthread_cond_wait(&async_drained, &async_mutex);
+    }
+    pthread_mutex_unlock(&async_mutex);
+#endif /* defined(CONSOLE_ASYNC_SUPPORTED) */
+}
+
+/**
+ * @brief   Get the number of messages (lines) dropped by the overflow policy since asynchronous logging was started.
+ */
+uint64_t console_async_get_drop_count(void) { return atomic_load(&async_drop_count); }
+
+/**
+ * @brief   Get a monotonic timestamp in nanoseconds.
+ */
+static uint64_t console_get_time_ns(void)
+{
+    struct timespec time;
+#if defined(CONSOLE_ASYNC_SUPPORTED)
+    clock_gettime(CLOCK_MONOTONIC, &time);
+#else
+    timespec_get(&time, TIME_UTC);
+#endif /* defined(CONSOLE_ASYNC_SUPPORTED) */
+    return ((uint64_t)time.tv_sec * 1000000000ull) + (uint64_t)time.tv_nsec;
+}
+
+/**
+ * @brief   Parse a single printf conversion specification.
+ *
+ * @param spec_start    Pointer to the '%' that starts the specification
+ * @param spec          The parsed specification
+ * @return const char*  Pointer to the character following the specification
+ */
+static const char *console_binlog_parse_spec_internal(const char *spec_start, ConsoleBinlogSpec_t *spec)
+{
+    const char *c = spec_start + 1;
+
+    memset(spec, 0, sizeof(*spec));
+
+    /* Flags */
+    while ((*c == '-') || (*c == '+') || (*c == ' ') || (*c == '#') || (*c == '0'))
+    {
+        c++;
+    }
+    /* Width */
+    if (*c == '*')
+    {
+        spec->num_stars++;
+        c++;
+    }
+    while (isdigit((unsigned char)*c))
+    {
+        c++;
+    }
+    /* Precision */
+    if (*c == '.')
+    {
+        c++;
+        if (*c == '*')
+        {
+            spec->num_stars++;
+            c++;
+        }
+        while (isdigit((unsigned char)*c))
+        {
+            c++;
+        }
+    }
+    /* Length modifier */
+    spec->length_start = (size_t)(c - spec_start);
+    switch (*c)
+    {
+        case 'h':
+            c += (c[1] == 'h') ? 2 : 1;
+            spec->arg = BINLOG_ARG_INT;
+            break;
+        case 'l':
+            spec->arg = (c[1] == 'l') ? BINLOG_ARG_LLONG : BINLOG_ARG_LONG;
+            c += (c[1] == 'l') ? 2 : 1;
+            break;
+        case 'j':
+            spec->arg = BINLOG_ARG_INTMAX;
+            c++;
+            break;
+        case 'z':
+            spec->arg = BINLOG_ARG_SIZE;
+            c++;
+            break;
+        case 't':
+            spec->arg = BINLOG_ARG_PTRDIFF;
+            c++;
+            break;
+        case 'L':
+            spec->arg = BINLOG_ARG_LDOUBLE;
+            c++;
+            break;
+        default:
+            spec->arg = BINLOG_ARG_INT;
+            break;
+    }
+    spec->length_end = (size_t)(c - spec_start);
+
+    /* Conversion */
+    spec->conversion = *c;
+    switch (*c)
+    {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            if (spec->arg == BINLOG_ARG_LDOUBLE)
+            {
+                spec->arg = BINLOG_ARG_LLONG;
+            }
+            break;
+        case 'c':
+            spec->arg = BINLOG_ARG_INT;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            spec->arg = (spec->arg == BINLOG_ARG_LDOUBLE) ? BINLOG_ARG_LDOUBLE : BINLOG_ARG_DOUBLE;
+            break;
+        case 's':
+            spec->arg = BINLOG_ARG_STRING;
+            break;
+        case 'p':
+            spec->arg = BINLOG_ARG_POINTER;
+            break;
+        case 'n':
+            spec->arg = BINLOG_ARG_SKIP;
+            break;
+        case '%':
+            spec->arg = BINLOG_ARG_NONE;
+            break;
+        default:
+            /* Not something we understand, treat it as literal text */
+            spec->arg        = BINLOG_ARG_NONE;
+            spec->conversion = 0;
+            return c;
+    }
+
+    return c + 1;
+}
+
+/**
+ * @brief   Look up (or build) the argument signature of a format string. Signatures are cached per thread, keyed by the
+ *          format string pointer, so the hot path normally doesn't have to parse the format string at all.
+ *
+ * @param format                        The format string
+ * @return ConsoleBinlogSignature_t*    The argument signature
+ */
+static ConsoleBinlogSignature_t *console_binlog_get_signature_internal(const char *format)
+{
+    ConsoleBinlogSignature_t *signature = &binlog_signature_cache[((uintptr_t)format >> 3) % BINLOG_SIGNATURE_CACHE_SIZE];
+    ConsoleBinlogSpec_t       spec;
+
+    if (signature->format == format)
+    {
+        return signature;
+    }
+
+    signature->format   = format;
+    signature->num_args = 0;
+    while (*format)
+    {
+        if (*format != '%')
+        {
+            format++;
+            continue;
+        }
+        format = console_binlog_parse_spec_internal(format, &spec);
+        for (unsigned int i = 0; (i < spec.num_stars) && (signature->num_args < BINLOG_MAX_ARGS); i++)
+        {
+            signature->args[signature->num_args++] = BINLOG_ARG_INT;
+        }
+        if ((spec.arg != BINLOG_ARG_NONE) && (signature->num_args < BINLOG_MAX_ARGS))
+        {
+            signature->args[signature->num_args++] = spec.arg;
+        }
+    }
+
+    return signature;
+}
+
+/**
+ * @brief   Start binary logging. Calls to console_binlog() record the format string pointer, a timestamp and the raw
+ *          argument bytes into a ring, formatting is deferred to console_binlog_drain() or to the offline decoder fed by
+ *          console_binlog_dump(). Records are dropped (and counted) if the ring is full.
+ *
+ * @param ring_length       The number of records in the ring (rounded up to a power of two)
+ * @return FunctionResult_e FR_OK on success, FR_BUSY if already started, FR_NOMEM if the ring couldn't be allocated
+ */
+FunctionResult_e console_binlog_start(unsigned int ring_length)
+{
+    size_t length = 2;
+
+    if (atomic_load(&binlog_running))
+    {
+        return FR_BUSY;
+    }
+
+    while (length < ring_length)
+    {
+        length <<= 1;
+    }
+
+    free(binlog_ring);
+    binlog_ring = (ConsoleBinlogRecord_t *)malloc(sizeof(ConsoleBinlogRecord_t) * length);
+    if (!binlog_ring)
+    {
+        return FR_NOMEM;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        atomic_init(&binlog_ring[i].sequence, i);
+    }
+    binlog_ring_mask        = length - 1;
+    atomic_store(&binlog_write_index, 0);
+    atomic_store(&binlog_read_index, 0);
+    atomic_store(&binlog_drop_count, 0);
+    atomic_store(&binlog_running, true);
+
+    return FR_OK;
+}
+
+/**
+ * @brief   Stop binary logging. Records still in the ring stay there until drained or dumped.
+ */
+void console_binlog_stop(void) { atomic_store(&binlog_running, false); }
+
+/**
+ * @brief   Record a log message without formatting it. Use the CONSOLE_BINLOG() macro to also skip argument evaluation
+ *          for filtered logging levels. Strings arguments are copied, everything else is stored as raw bytes.
+ *
+ * @param logging_level The logging level of the message
+ * @param format        The format string, must have static storage duration since only its pointer is stored
+ * @param ...           The format arguments
+ */
+void console_binlog(LoggingLevel_e logging_level, const char *format, ...)
+{
+    ConsoleBinlogSignature_t *signature;
+    ConsoleBinlogRecord_t    *record;
+    size_t                    index;
+    size_t                    args_size = 0;
+    va_list                   args;
+
+    if (!console_logging_enabled(logging_level) || !atomic_load_explicit(&binlog_running, memory_order_relaxed))
+    {
+        return;
+    }
+
+    /* Claim a record (single attempt, a full ring drops the newest record) */
+    index = atomic_load_explicit(&binlog_write_index, memory_order_relaxed);
+    for (;;)
+    {
+        record              = &binlog_ring[index & binlog_ring_mask];
+        size_t   sequence   = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)index;
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&binlog_write_index, &index, index + 1, memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
             }
         }
+        else if (difference < 0)
+        {
+            atomic_fetch_add_explicit(&binlog_drop_count, 1, memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            index = atomic_load_explicit(&binlog_write_index, memory_order_relaxed);
+        }
+    }
 
-        /* We didn't get a valid value yet */
-        if (!valid)
+    record->format        = format;
+    record->timestamp     = console_get_time_ns();
+    record->logging_level = logging_level;
+
+    signature = console_binlog_get_signature_internal(format);
+    va_start(args, format);
+    for (unsigned int i = 0; i < signature->num_args; i++)
+    {
+        int64_t value = 0;
+        double  real  = 0;
+
+        if (signature->args[i] == BINLOG_ARG_STRING)
         {
-            for (unsigned int i = 0; i < num_selections; i++)
+            const char *string = va_arg(args, const char *);
+            size_t      length;
+            if (!string)
             {
-                if (c == selections[i].key)
-                {
-                    valid = true;
-                    break;
-                }
+                string = "(null)";
             }
+            if (args_size >= BINLOG_ARGS_SIZE)
+            {
+                break;
+            }
+            length = strnlen(string, BINLOG_ARGS_SIZE - args_size - 1);
+            memcpy(&record->args[args_size], string, length);
+            record->args[args_size + length] = '\0';
+            args_size += length + 1;
+            continue;
         }
 
-        if (!valid)
+        switch (signature->args[i])
         {
-            console_print_new_line(LOGGING_LEVEL_0);
-            console_print(LOGGING_LEVEL_0, "Bad selection %c! ", c);
+            case BINLOG_ARG_INT:
+                value = va_arg(args, int);
+                break;
+            case BINLOG_ARG_LONG:
+                value = va_arg(args, long);
+                break;
+            case BINLOG_ARG_LLONG:
+                value = va_arg(args, long long);
+                break;
+            case BINLOG_ARG_INTMAX:
+                value = va_arg(args, intmax_t);
+                break;
+            case BINLOG_ARG_SIZE:
+                value = (int64_t)va_arg(args, size_t);
+                break;
+            case BINLOG_ARG_PTRDIFF:
+                value = va_arg(args, ptrdiff_t);
+                break;
+            case BINLOG_ARG_POINTER:
+            case BINLOG_ARG_SKIP:
+                value = (int64_t)(uintptr_t)va_arg(args, void *);
+                break;
+            case BINLOG_ARG_DOUBLE:
+                real = va_arg(args, double);
+                memcpy(&value, &real, sizeof(value));
+                break;
+            case BINLOG_ARG_LDOUBLE:
+                real = (double)va_arg(args, long double);
+                memcpy(&value, &real, sizeof(value));
+                break;
+            default:
+                break;
         }
-    } while (!valid);
-
-    console_print(LOGGING_LEVEL_0, ANSI_COLOR_GREEN " Selecting %c!" ANSI_COLOR_RESET, c);
-    if (!(option_flags & NO_DIVIDERS))
-    {
-        console_print_divider(LOGGING_LEVEL_0);
+        if (args_size + sizeof(value) > BINLOG_ARGS_SIZE)
+        {
+            break;
+        }
+        memcpy(&record->args[args_size], &value, sizeof(value));
+        args_size += sizeof(value);
     }
-
-    return c;
-}
-
-void console_print(LoggingLevel_e logging_level, const char *format, ...)
-{
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
     va_end(args);
-    console_put_string_internal(logging_level, string_buffer);
-    console_print_new_line(logging_level);
-}
+    record->args_size = (uint16_t)args_size;
 
-void console_print_in_place(LoggingLevel_e logging_level, const char *format, ...)
-{
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_put_string_internal(logging_level, "\33[2K"); /* Clear out the line*/
-    console_put_string_internal(logging_level, string_buffer);
-    console_put_char_internal(logging_level, '\r');
-    fflush(stdout);
+    atomic_store_explicit(&record->sequence, index + 1, memory_order_release);
 }
 
-void console_print_block(LoggingLevel_e logging_level, const char *block_string)
+/**
+ * @brief   Format a binary log record. This walks the format string and formats one conversion at a time from the raw
+ *          argument bytes, conversions whose arguments didn't fit in the record are printed as '?'.
+ *
+ * @param buffer        The string buffer to write into
+ * @param buff_size     The string buffer size
+ * @param format        The record's format string
+ * @param args          The record's raw argument bytes
+ * @param args_size     The number of raw argument bytes
+ * @return size_t       The length of the formatted string
+ */
+size_t console_binlog_format(char *buffer, size_t buff_size, const char *format, const uint8_t *args, size_t args_size)
 {
-    size_t total_string_len      = console_isprint_str_len(block_string);
-    size_t line_start            = 0;
-    size_t line_end              = 0;
-    size_t line_end_space        = 0;
-    size_t printable_line_length = 0;
-    bool   inside_escape_code    = false;
+    ConsoleBinlogSpec_t spec;
+    size_t              length      = 0;
+    size_t              args_offset = 0;
+    bool                exhausted   = false;
 
-    while (line_start < total_string_len)
+    if (buff_size == 0)
+    {
+        return 0;
+    }
+    buffer[0] = '\0';
+
+    while (*format && (length < buff_size - 1))
     {
-        line_end              = line_start;
-        printable_line_length = 0;
-        /* Extract a line up to TEXT_BLOCK_SIZE of printable characters */
-        while (block_string[line_end] != 0)
+        const char *spec_start = format;
+        char        spec_buffer[64];
+        size_t      spec_length;
+        int64_t     stars[2] = {0};
+        int64_t     value    = 0;
+        int         written  = 0;
+
+        if (*format != '%')
+        {
+            buffer[length++] = *format++;
+            buffer[length]   = '\0';
+            continue;
+        }
+
+        format      = console_binlog_parse_spec_internal(format, &spec);
+        spec_length = (size_t)(format - spec_start);
+        if (spec.conversion == 0)
+        {
+            /* Unknown conversion, copy it out verbatim */
+            written = snprintf(&buffer[length], buff_size - length, "%.*s", (int)spec_length, spec_start);
+        }
+        else if (spec.conversion == '%')
+        {
+            written = snprintf(&buffer[length], buff_size - length, "%%");
+        }
+        else
         {
-            /* Ignore ANSI escape sequences */
-            if (block_string[line_end] == '\x1b')
+            /* Pull this conversion's arguments out of the record */
+            for (unsigned int i = 0; i < spec.num_stars; i++)
             {
-                inside_escape_code = true;
+                if (args_offset + sizeof(int64_t) > args_size)
+                {
+                    exhausted = true;
+                    break;
+                }
+                memcpy(&stars[i], &args[args_offset], sizeof(int64_t));
+                args_offset += sizeof(int64_t);
             }
-            else if (inside_escape_code && ((block_string[line_end] == 'm') || (block_string[line_end] == 'J')))
+            if (!exhausted && (spec.arg == BINLOG_ARG_STRING))
             {
-                inside_escape_code = false;
+                exhausted = (args_offset >= args_size) || !memchr(&args[args_offset], '\0', args_size - args_offset);
             }
-            else if (!inside_escape_code && isprint(block_string[line_end]))
+            else if (!exhausted)
             {
-                printable_line_length++;
+                exhausted = (args_offset + sizeof(int64_t) > args_size);
+                if (!exhausted)
+                {
+                    memcpy(&value, &args[args_offset], sizeof(int64_t));
+                }
             }
-            line_end++;
 
-            if (printable_line_length >= TEXT_BLOCK_SIZE)
+            if (exhausted)
             {
-                break;
+                written = snprintf(&buffer[length], buff_size - length, "?");
             }
-        }
-
-        /* Step back until we find a space  and we haven't lapped the line_start.*/
-        if (printable_line_length >= TEXT_BLOCK_SIZE)
-        {
-            line_end_space = line_end;
-            while ((block_string[line_end_space] != ' ') && (line_end_space > line_start))
+            else
             {
-                line_end_space--;
-            }
+                /* Rebuild the specification with '*' replaced by the recorded values and the length modifier
+                normalized to the type we stored */
+                size_t      out          = 0;
+                unsigned    star         = 0;
+                const char *length_chars = "";
 
-            /* If we find a space, print up to that space. */
-            if (line_end_space != line_start)
-            {
-                line_end = line_end_space;
+                for (size_t i = 0; (i < spec.length_start) && (out < sizeof(spec_buffer) - 24); i++)
+                {
+                    if (spec_start[i] == '*')
+                    {
+                        out += snprintf(&spec_buffer[out], sizeof(spec_buffer) - out, "%" PRId64, stars[star++]);
+                    }
+                    else
+                    {
+                        spec_buffer[out++] = spec_start[i];
+                    }
+                }
+                switch (spec.arg)
+                {
+                    case BINLOG_ARG_LONG:
+                    case BINLOG_ARG_LLONG:
+                    case BINLOG_ARG_INTMAX:
+                    case BINLOG_ARG_SIZE:
+                    case BINLOG_ARG_PTRDIFF:
+                        length_chars = "ll";
+                        break;
+                    case BINLOG_ARG_INT:
+                        /* Keep h and hh, they truncate the value the way the caller asked for */
+                        snprintf(&spec_buffer[out], sizeof(spec_buffer) - out, "%.*s", (int)(spec.length_end - spec.length_start), &spec_start[spec.length_start]);
+                        out += spec.length_end - spec.length_start;
+                        break;
+                    default:
+                        break;
+                }
+                snprintf(&spec_buffer[out], sizeof(spec_buffer) - out, "%s%c", length_chars, spec.conversion);
+
+                switch (spec.arg)
+                {
+                    case BINLOG_ARG_STRING:
+                        written = snprintf(&buffer[length], buff_size - length, spec_buffer, (const char *)&args[args_offset]);
+                        args_offset += strlen((const char *)&args[args_offset]) + 1;
+                        break;
+                    case BINLOG_ARG_INT:
+                        written = snprintf(&buffer[length], buff_size - length, spec_buffer, (int)value);
+                        args_offset += sizeof(int64_t);
+                        break;
+                    case BINLOG_ARG_LONG:
+                    case BINLOG_ARG_LLONG:
+                    case BINLOG_ARG_INTMAX:
+                    case BINLOG_ARG_SIZE:
+                    case BINLOG_ARG_PTRDIFF:
+                        written = snprintf(&buffer[length], buff_size - length, spec_buffer, (long long)value);
+                        args_offset += sizeof(int64_t);
+                        break;
+                    case BINLOG_ARG_DOUBLE:
+                    case BINLOG_ARG_LDOUBLE:
+                    {
+                        double real;
+                        memcpy(&real, &value, sizeof(real));
+                        written = snprintf(&buffer[length], buff_size - length, spec_buffer, real);
+                        args_offset += sizeof(int64_t);
+                        break;
+                    }
+                    case BINLOG_ARG_POINTER:
+                        written = snprintf(&buffer[length], buff_size - length, spec_buffer, (void *)(uintptr_t)value);
+                        args_offset += sizeof(int64_t);
+                        break;
+                    case BINLOG_ARG_SKIP:
+                    default:
+                        args_offset += sizeof(int64_t);
+                        break;
+                }
             }
         }
 
-        /* Print from line_start to line_end (add a character margin) */
-        console_put_char_internal(logging_level, ' ');
-        for (size_t i = line_start; i < line_end; i++)
+        if (written > 0)
         {
-            if (!block_string[i])
+            length += (size_t)written;
+            if (length > buff_size - 1)
             {
-                /* NULL! We're done here. */
-                break;
+                length = buff_size - 1;
             }
-
-            console_put_char_internal(logging_level, block_string[i]);
         }
-        console_put_char_internal(logging_level, '\n');
-
-        /* New line */
-        line_start = line_end + 1;
     }
-}
 
-void console_print_color(LoggingLevel_e logging_level, const char *color_string, const char *inner_string)
-{
-    console_put_string_internal(logging_level, color_string);
-    console_put_string_internal(logging_level, inner_string);
-    console_put_string_internal(logging_level, ANSI_COLOR_RESET);
-    console_print_new_line(logging_level);
-}
-
-void console_print_color_no_eol(LoggingLevel_e logging_level, const char *color_string, const char *inner_string)
-{
-    console_put_string_internal(logging_level, color_string);
-    console_put_string_internal(logging_level, inner_string);
-    console_put_string_internal(logging_level, ANSI_COLOR_RESET);
-}
-
-void console_print_debug(LoggingLevel_e logging_level, const char *format, ...)
-{
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_print_color(logging_level, ANSI_COLOR_MAGENTA, string_buffer);
-}
-
-void console_print_debug_no_eol(LoggingLevel_e logging_level, const char *format, ...)
-{
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_print_color_no_eol(logging_level, ANSI_COLOR_MAGENTA, string_buffer);
-}
-
-void console_print_debug_new_line(LoggingLevel_e logging_level)
-{
-    console_put_string_internal(logging_level, "\r\n");
-}
-
-void console_print_error(LoggingLevel_e logging_level, const char *format, ...)
-{
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_print_color(logging_level, ANSI_COLOR_RED, string_buffer);
+    return length;
 }
 
-void console_print_warn(LoggingLevel_e logging_level, const char *format, ...)
-{
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_print_color(logging_level, ANSI_COLOR_YELLOW, string_buffer);
-}
-
-void console_print_success(LoggingLevel_e logging_level, const char *format, ...)
+/**
+ * @brief   Take the oldest record out of the binary log ring.
+ *
+ * @param record    Where to copy the record to
+ * @return true     A record was taken out
+ * @return false    The ring was empty
+ */
+static bool console_binlog_pop_internal(ConsoleBinlogRecord_t *record)
 {
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_print_color(logging_level, ANSI_COLOR_GREEN, string_buffer);
-}
+    size_t index = atomic_load_explicit(&binlog_read_index, memory_order_relaxed);
 
-void console_print_no_eol(LoggingLevel_e logging_level, const char *format, ...)
-{
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_put_string_internal(logging_level, string_buffer);
-}
+    for (;;)
+    {
+        ConsoleBinlogRecord_t *cell       = &binlog_ring[index & binlog_ring_mask];
+        size_t                 sequence   = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t               difference = (intptr_t)sequence - (intptr_t)(index + 1);
 
-void console_print_new_line(LoggingLevel_e logging_level)
-{
-    console_put_string_internal(logging_level, "\r\n");
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&binlog_read_index, &index, index + 1, memory_order_relaxed, memory_order_relaxed))
+            {
+                record->format        = cell->format;
+                record->timestamp     = cell->timestamp;
+                record->logging_level = cell->logging_level;
+                record->args_size     = cell->args_size;
+                memcpy(record->args, cell->args, cell->args_size);
+                atomic_store_explicit(&cell->sequence, index + binlog_ring_mask + 1, memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            index = atomic_load_explicit(&binlog_read_index, memory_order_relaxed);
+        }
+    }
 }
 
-void console_print_header(LoggingLevel_e logging_level, const char *format, ...)
+/**
+ * @brief   Format every pending binary log record and print it at its logging level, prefixed with its timestamp.
+ *
+ * @return unsigned int The number of records drained
+ */
+unsigned int console_binlog_drain(void)
 {
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_print_header_internal(logging_level, DBL_LINE_CHAR, string_buffer);
-}
+    static CONSOLE_THREAD_LOCAL ConsoleBinlogRecord_t record;
+    char                                              buffer[STRING_BUFFER_SIZE];
+    unsigned int                                      count = 0;
 
-void console_print_sub_header(LoggingLevel_e logging_level, const char *format, ...)
-{
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_print_header_internal(logging_level, SGL_LINE_CHAR, string_buffer);
-}
+    if (!binlog_ring)
+    {
+        return 0;
+    }
 
-void console_print_footer_banner(LoggingLevel_e logging_level, const char *format, ...)
-{
-    char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-    va_end(args);
-    console_print_divider(logging_level);
-    console_put_string_internal(logging_level, "  "); /* Add some space */
-    console_put_string_internal(logging_level, string_buffer);
-    console_print_divider(logging_level);
+    while (console_binlog_pop_internal(&record))
+    {
+        console_binlog_format(buffer, sizeof(buffer), record.format, record.args, record.args_size);
+        console_print(record.logging_level, "[%" PRIu64 ".%09" PRIu64 "] %s", (uint64_t)(record.timestamp / 1000000000ull),
+                      (uint64_t)(record.timestamp % 1000000000ull), buffer);
+        count++;
+    }
+
+    return count;
 }
 
-void console_print_header_internal(LoggingLevel_e logging_level, const char *ruler_string, const char *header_string)
+/**
+ * @brief   Write every pending binary log record to a file for the offline decoder (umami-binlog-decode). Each call
+ *          writes a self-contained section, a header followed by the records and the format strings they use (each
+ *          defined the first time it's seen), so successive dumps can be appended to the same file. The file uses native
+ *          byte order.
+ *
+ * @param file          The file to write to, should be opened in binary mode
+ * @return unsigned int The number of records written
+ */
+unsigned int console_binlog_dump(FILE *file)
 {
-    unsigned int is_print_string_length = console_isprint_str_len(header_string);
+    static CONSOLE_THREAD_LOCAL ConsoleBinlogRecord_t record;
+    const char                                      **formats     = NULL;
+    uint32_t                                          num_formats = 0;
+    uint32_t                                          version     = BINLOG_FILE_VERSION;
+    unsigned int                                      count       = 0;
 
-    if (is_print_string_length > MAX_HEADER_TITLE_WIDTH)
+    if (!binlog_ring || !file)
     {
-        is_print_string_length = MAX_HEADER_TITLE_WIDTH;
+        return 0;
     }
-    console_print_new_line(logging_level);
-    console_print_no_eol(logging_level, "%s[" ANSI_COLOR_YELLOW " %s " ANSI_COLOR_RESET "]%s", ruler_string, header_string, ruler_string);
-    if (!console_settings->small_headers)
+
+    fwrite(BINLOG_FILE_MAGIC, 1, 4, file);
+    fwrite(&version, sizeof(version), 1, file);
+
+    for (;;)
     {
-        for (unsigned int i = 0; i < (CONSOLE_WIDTH - is_print_string_length - HEADER_TITLE_EXTRAS_WIDTH); i++)
+        uint32_t format_id;
+        uint64_t timestamp;
+        int8_t   logging_level;
+        uint16_t args_size;
+
+        /* Make room for a new format string before taking a record off the ring, so a failure leaves it there */
+        if ((num_formats % 64) == 0)
+        {
+            const char **new_formats = (const char **)realloc((void *)formats, sizeof(const char *) * (num_formats + 64));
+            if (!new_formats)
+            {
+                break;
+            }
+            formats = new_formats;
+        }
+
+        if (!console_binlog_pop_internal(&record))
+        {
+            break;
+        }
+        timestamp     = record.timestamp;
+        logging_level = (int8_t)record.logging_level;
+        args_size     = record.args_size;
+
+        /* Find the format string's id, defining it in the section if this is its first appearance */
+        for (format_id = 0; format_id < num_formats; format_id++)
         {
-            console_print_no_eol(logging_level, "%s", ruler_string);
+            if (formats[format_id] == record.format)
+            {
+                break;
+            }
+        }
+        if (format_id == num_formats)
+        {
+            uint16_t format_length = (uint16_t)strlen(record.format);
+            formats[num_formats++] = record.format;
+            fputc(BINLOG_FILE_TAG_FORMAT, file);
+            fwrite(&format_id, sizeof(format_id), 1, file);
+            fwrite(&format_length, sizeof(format_length), 1, file);
+            fwrite(record.format, 1, format_length, file);
         }
+
+        fputc(BINLOG_FILE_TAG_RECORD, file);
+        fwrite(&format_id, sizeof(format_id), 1, file);
+        fwrite(&timestamp, sizeof(timestamp), 1, file);
+        fwrite(&logging_level, sizeof(logging_level), 1, file);
+        fwrite(&args_size, sizeof(args_size), 1, file);
+        fwrite(record.args, 1, args_size, file);
+        count++;
     }
-    console_print_new_line(logging_level);
-    console_print_new_line(logging_level);
+
+    free((void *)formats);
+
+    return count;
 }
 
-void console_print_divider(LoggingLevel_e logging_level)
+/**
+ * @brief   Get the number of binary log records dropped because the ring was full.
+ */
+uint64_t console_binlog_get_drop_count(void) { return atomic_load(&binlog_drop_count); }
+
+#if defined(CONSOLE_POSIX_INPUT_SUPPORTED)
+static struct termios        posix_saved_termios;      ///< Terminal settings to put back when we're done
+static struct termios        posix_raw_termios;        ///< Terminal settings while waiting on single keys
+static volatile sig_atomic_t posix_raw_active = 0;     ///< Set while the terminal is ours, read from signal handlers
+static bool                  posix_line_mode  = false; ///< Set while a prompt has the terminal in line mode
+static bool                  posix_input_ended = false; ///< Set once stdin has run out
+
+/* Signals that end the program, the terminal is restored before they take effect */
+static const int posix_restore_signals[] = {SIGINT, SIGTERM, SIGHUP, SIGQUIT};
+
+/**
+ * @brief   Put the terminal back the way we found it. Only uses async-signal-safe calls.
+ */
+static void console_posix_restore_internal(void)
 {
-    for (unsigned int i = 0; i < CONSOLE_WIDTH; i++)
+    if (posix_raw_active)
     {
-        console_print_no_eol(logging_level, "%s", SGL_LINE_CHAR);
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &posix_saved_termios);
+        posix_raw_active = 0;
     }
-    console_print_new_line(logging_level);
 }
 
-void console_print_menu(ConsoleMenu_t *menu)
+/**
+ * @brief   Restore the terminal, then let the signal do what it would have done without us.
+ */
+static void console_posix_signal_internal(int signal_number)
 {
-    unsigned int total_pages = TOTAL_PAGES(menu->menu_length);
-    unsigned int start_index;
-    unsigned int end_index;
-    unsigned int menu_offset;
-    unsigned int list_offset;
-    const char   menu_breadcrumb_separator[]                               = BREADCRUMB_SEPARATOR;
-    char         menu_breadcrumb_string[MAX_MENU_DESCRIPTION_LENGTH + 100] = {0}; /* Adding a bit of breathing room for the breadcrumb to move */
+    console_posix_restore_internal();
+    signal(signal_number, SIG_DFL);
+    raise(signal_number);
+}
+#endif /* defined(CONSOLE_POSIX_INPUT_SUPPORTED) */
 
-    /* Make breadcrumbs */
-    ConsoleMenu_t *menu_breadcrumb = menu;
-    snprintf(menu_breadcrumb_string, sizeof(menu_breadcrumb_string), "%s" ANSI_COLOR_RESET, menu_breadcrumb->id.name);
-    do
-    {
-        /* Go up a level */
-        menu_breadcrumb = menu_breadcrumb->parent_menu;
-        if (menu_breadcrumb)
-        {
-            size_t parent_menu_name_length = strlen(menu_breadcrumb->id.name);
-            size_t separator_length        = strlen(menu_breadcrumb_separator);
-            memmove(menu_breadcrumb_string + parent_menu_name_length + separator_length, menu_breadcrumb_string, strlen(menu_breadcrumb_string));
-            strncpy(menu_breadcrumb_string, menu_breadcrumb->id.name, parent_menu_name_length);
-            strncpy(menu_breadcrumb_string + parent_menu_name_length, menu_breadcrumb_separator, strlen(menu_breadcrumb_separator));
-        }
-    } while (menu_breadcrumb);
+/**
+ * @brief   Built-in POSIX input backend, meant to be called from os_init_fn. Puts the terminal into single key mode
+ *          (no line buffering, no echo) once for the whole session with tcsetattr() and puts it back at exit or when a
+ *          terminating signal arrives. Ctrl-C and friends keep working. stdin is made unbuffered so keys and prompts
+ *          can share it, beyond that nothing changes when stdin isn't a terminal.
+ *
+ * @return FunctionResult_e FR_OK if the backend is ready, FR_FAIL if the terminal settings couldn't be changed,
+ *                          FR_UNSUPPORTED on platforms without termios
+ */
+FunctionResult_e console_posix_input_init(void)
+{
+#if defined(CONSOLE_POSIX_INPUT_SUPPORTED)
+    static bool restore_registered = false;
 
-    /**
-     * Mutable menus update dynamically, so no need to offset reading the menu array
-     * ToDo: there HAS to be a better way of doing this
-     */
+    /* Keys are read with read(), so stdio mustn't read ahead of us on behalf of the line prompts */
+    setvbuf(stdin, NULL, _IONBF, 0);
 
-    if (menu->mode == MENU_MUTABLE)
-    {
-        menu_offset = (menu->current_page * PAGE_LENGTH);
-        list_offset = 0;
-    }
-    else
+    if (!isatty(STDIN_FILENO) || posix_raw_active)
     {
-        menu_offset = 0;
-        list_offset = (menu->current_page * PAGE_LENGTH);
+        return FR_OK;
     }
 
-    /* Calculate start and end indices */
-    start_index = (menu->current_page * PAGE_LENGTH) - menu_offset;
-    end_index   = start_index + PAGE_LENGTH;
-    if (end_index > (menu->menu_length - menu_offset))
+    if (tcgetattr(STDIN_FILENO, &posix_saved_termios) != 0)
     {
-        end_index = (menu->menu_length - menu_offset);
+        return FR_FAIL;
     }
 
-    console_print_header(LOGGING_LEVEL_0, "%s", menu_breadcrumb_string);
-    console_print_no_eol(LOGGING_LEVEL_0, " %s", menu->id.description);
+    /* Unlike stty raw, output processing and signals are left alone */
+    posix_raw_termios = posix_saved_termios;
+    posix_raw_termios.c_lflag &= ~(tcflag_t)(ICANON | ECHO);
+    posix_raw_termios.c_cc[VMIN]  = 1;
+    posix_raw_termios.c_cc[VTIME] = 0;
 
-    if (total_pages > 1)
+    if (!restore_registered)
     {
-        console_print(LOGGING_LEVEL_0, " - Page (%i/%i)", menu->current_page + 1, total_pages);
+        atexit(console_posix_restore_internal);
+        for (size_t i = 0; i < sizeof(posix_restore_signals) / sizeof(posix_restore_signals[0]); i++)
+        {
+            struct sigaction action;
+
+            /* Don't take over signals the application already handles */
+            if ((sigaction(posix_restore_signals[i], NULL, &action) == 0) && (action.sa_handler == SIG_DFL))
+            {
+                action.sa_handler = console_posix_signal_internal;
+                sigemptyset(&action.sa_mask);
+                action.sa_flags = 0;
+                sigaction(posix_restore_signals[i], &action, NULL);
+            }
+        }
+        restore_registered = true;
     }
-    else
+
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &posix_raw_termios) != 0)
     {
-        console_print_new_line(LOGGING_LEVEL_0);
+        return FR_FAIL;
     }
+    posix_raw_active = 1;
 
-    if (menu->menu_length)
+    return FR_OK;
+#else
+    return FR_UNSUPPORTED;
+#endif /* defined(CONSOLE_POSIX_INPUT_SUPPORTED) */
+}
+
+/**
+ * @brief   Built-in POSIX get_char_fn. Reads straight from stdin a byte at a time without stdio buffering and returns the
+ *          first key, see console_posix_wait_for_char(). Returns '\0' once input runs out, e.g. at the end of piped keys.
+ */
+char console_posix_get_char(void)
+{
+#if defined(CONSOLE_POSIX_INPUT_SUPPORTED)
+    return console_posix_wait_for_char(-1);
+#else
+    return '\0';
+#endif /* defined(CONSOLE_POSIX_INPUT_SUPPORTED) */
+}
+
+/**
+ * @brief   Built-in POSIX wait_for_char_fn. Waits in poll() until a printable character, Enter ('\n') or backspace
+ *          ('\b') arrives on stdin or the timeout expires, other bytes are consumed and ignored. Once input runs out
+ *          this returns '\0' straight away, see console_posix_input_ended().
+ *
+ * @param timeout_ms    How long to wait in milliseconds, 0 to only check, negative to wait forever
+ * @return char         The key, or '\0' on timeout or once input has run out
+ */
+char console_posix_wait_for_char(int timeout_ms)
+{
+#if defined(CONSOLE_POSIX_INPUT_SUPPORTED)
+    struct pollfd poll_fd      = {.fd = STDIN_FILENO, .events = POLLIN};
+    uint64_t      deadline     = console_get_time_ns() + (uint64_t)(timeout_ms > 0 ? timeout_ms : 0) * 1000000;
+    int           remaining_ms = timeout_ms;
+    unsigned char c;
+
+    while (!posix_input_ended)
     {
-        /* Space above the menu options */
-        console_print_new_line(LOGGING_LEVEL_0);
-        /**
-         * If we have multiple pages and we aren't on the first page, indicate
-         * to the user that they can go to the previous page
-         */
-        if ((total_pages > 1) && (menu->current_page > 0))
+        int     ready = poll(&poll_fd, 1, remaining_ms);
+        ssize_t result;
+
+        if (ready == 0)
         {
-            console_print(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW "p" ANSI_COLOR_RESET "] <<< Prev Page");
+            return '\0';
         }
-        for (unsigned int i = start_index; i < end_index; i++)
+
+        if (ready > 0)
         {
-            ConsoleMenuItem_t *menu_item = &(menu->menu_items[i + menu_offset]);
-            console_print_no_eol(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW "%c" ANSI_COLOR_RESET "] %s", '0' + i - list_offset, menu_item->id.name);
-            if (menu_item->id.description[0] != '\0')
+            result = read(STDIN_FILENO, &c, 1);
+            if (result == 0)
             {
-                console_print(LOGGING_LEVEL_0, " - %s", menu_item->id.description);
+                posix_input_ended = true;
+                break;
             }
-            else
+            if ((result == 1) && (isprint(c) || (c == '\b')))
             {
-                console_print_new_line(LOGGING_LEVEL_0);
+                return (char)c;
+            }
+            /* Enter and backspace, as the terminal sends them */
+            if ((result == 1) && ((c == '\r') || (c == '\n')))
+            {
+                return '\n';
+            }
+            if ((result == 1) && (c == 0x7f))
+            {
+                return '\b';
             }
         }
-        /**
-         * If we have multiple pages and we aren't on the first page, indicate
-         * to the user that they can go to the next page
-         */
-        if ((total_pages > 1) && (menu->current_page < (total_pages - 1)))
+
+        /* Interrupted, or a byte we don't care about, keep waiting out whatever is left of the timeout */
+        if (timeout_ms > 0)
         {
-            console_print(LOGGING_LEVEL_0, " [" ANSI_COLOR_YELLOW "n" ANSI_COLOR_RESET "] >>> Next Page");
+            uint64_t now = console_get_time_ns();
+
+            remaining_ms = (now >= deadline) ? 0 : (int)((deadline - now + 999999) / 1000000);
         }
-        /* Space below the menu options */
-        console_print_new_line(LOGGING_LEVEL_0);
     }
-    else
+
+    return '\0';
+#else
+    IGNORE_UNUSED_ARG(timeout_ms);
+    return '\0';
+#endif /* defined(CONSOLE_POSIX_INPUT_SUPPORTED) */
+}
+
+/**
+ * @brief   Built-in POSIX input_ended_fn. Tells whether stdin has run out, after which the backend only returns '\0'.
+ */
+bool console_posix_input_ended(void)
+{
+#if defined(CONSOLE_POSIX_INPUT_SUPPORTED)
+    return posix_input_ended;
+#else
+    return false;
+#endif /* defined(CONSOLE_POSIX_INPUT_SUPPORTED) */
+}
+
+/**
+ * @brief   Built-in POSIX line_mode_fn. Hands the terminal back to the line discipline (echo, backspace) while a prompt
+ *          reads a whole line and switches back to single keys afterwards.
+ *
+ * @param enable    True before reading a line, false after
+ */
+void console_posix_line_mode(bool enable)
+{
+#if defined(CONSOLE_POSIX_INPUT_SUPPORTED)
+    if (enable && posix_raw_active)
     {
-        console_print_new_line(LOGGING_LEVEL_0);
-        console_print_warn(LOGGING_LEVEL_0, " <empty like your cup of coffee>");
-        console_print_new_line(LOGGING_LEVEL_0);
+        tcsetattr(STDIN_FILENO, TCSANOW, &posix_saved_termios);
+        posix_raw_active = 0;
+        posix_line_mode  = true;
+    }
+    else if (!enable && posix_line_mode)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &posix_raw_termios);
+        posix_raw_active = 1;
+        posix_line_mode  = false;
     }
+#else
+    IGNORE_UNUSED_ARG(enable);
+#endif /* defined(CONSOLE_POSIX_INPUT_SUPPORTED) */
 }
 
-unsigned int console_get_string_buffer_index()
+/**
+ * @brief   Read a line for one of the prompts, letting the input backend switch the terminal into line mode around it.
+ *
+ * @param buffer    The buffer to read into
+ * @param buff_size The buffer size
+ * @return char*    buffer, or NULL if nothing could be read
+ */
+static char *console_read_line_internal(char *buffer, size_t buff_size)
 {
+    char *line = buffer;
+    char *result;
 
-    unsigned int returned_string_buffer_index = current_string_buffer_index;
+    if (script_file)
+    {
+        return console_script_read_line_internal(buffer, buff_size);
+    }
 
-    if (++current_string_buffer_index >= NUM_STRING_BUFFERS)
+    /* The line may have been started before the prompt came up */
+    if (typeahead_key && (buff_size > 2))
     {
-        current_string_buffer_index = 0;
-    };
+        buffer[0]     = typeahead_key;
+        buffer[1]     = '\0';
+        typeahead_key = '\0';
+        if (buffer[0] == '\n')
+        {
+            return line;
+        }
+        console_put_char_internal(LOGGING_LEVEL_0, buffer[0]);
+        buffer++;
+        buff_size--;
+    }
 
-    return returned_string_buffer_index;
-}
+    console_async_flush();
+    if (console_settings->line_mode_fn)
+    {
+        console_settings->line_mode_fn(true);
+    }
+    result = fgets(buffer, (int)buff_size, stdin);
+    if (console_settings->line_mode_fn)
+    {
+        console_settings->line_mode_fn(false);
+    }
 
-LoggingLevel_e console_get_logging_level()
-{
-    return console_settings->logging_level;
+    return (result || (buffer != line)) ? line : NULL;
 }
 
+/**
+ * @brief   Check whether the input backend has run out of keys, e.g. at the end of piped input.
+ */
+static bool console_input_ended_internal(void) { return console_settings->input_ended_fn && console_settings->input_ended_fn(); }
+
+/**
+ * @brief   Get the next key. Once input runs out this keeps returning 'q' so every menu level quits, as for the end of a
+ *          script.
+ */
 char console_get_char_internal(LoggingLevel_e logging_level)
 {
-    if (console_settings->logging_level >= logging_level)
+    char c = typeahead_key;
+
+    if (c)
+    {
+        typeahead_key = '\0';
+        return c;
+    }
+    else if (script_file)
+    {
+        return console_script_get_char_internal();
+    }
+    else if (console_settings->logging_level >= logging_level)
     {
-        return console_settings->get_char_fn();
+        /* Whatever we've printed so far must reach the user before we wait on them */
+        console_async_flush();
+        c = console_settings->get_char_fn();
+        return (c || !console_input_ended_internal()) ? c : 'q';
     }
     else
     {
@@ -879,54 +4626,257 @@ char console_get_char_internal(LoggingLevel_e logging_level)
 
 void console_put_char_internal(LoggingLevel_e logging_level, char c)
 {
-    if (console_settings->logging_level >= logging_level)
+    console_write_internal(logging_level, &c, 1);
+}
+
+void console_put_string_internal(LoggingLevel_e logging_level, const char *string)
+{
+    console_write_internal(logging_level, string, strlen(string));
+}
+
+/**
+ * @brief   Append a span of bytes to the output buffer, flushing to the sink whenever the buffer fills up.
+ *
+ * @param logging_level The logging level for the write
+ * @param data          The bytes to write (need not be NUL terminated)
+ * @param length        The number of bytes to write
+ */
+void console_write_internal(LoggingLevel_e logging_level, const char *data, size_t length)
+{
+    if (console_settings->logging_level < logging_level)
+    {
+        return;
+    }
+
+    while (length)
+    {
+        size_t chunk_length = OUTPUT_BUFFER_SIZE - output_buffer_length;
+        if (chunk_length > length)
+        {
+            chunk_length = length;
+        }
+        memcpy(&output_buffer[output_buffer_length], data, chunk_length);
+        output_buffer_length += chunk_length;
+        data += chunk_length;
+        length -= chunk_length;
+
+        if ((output_buffer_length == OUTPUT_BUFFER_SIZE) && !(frame_open && console_frame_spill_internal()))
+        {
+            console_flush();
+        }
+    }
+
+    /* Threads other than the console thread emit whole lines as soon as they're complete */
+    if (!is_console_thread && output_buffer_length && (output_buffer[output_buffer_length - 1] == '\n'))
+    {
+        console_flush();
+    }
+}
+
+/**
+ * @brief   Scalar escape sequence aware scanner, also used to finish off what the vector scanners leave behind. Handles
+ *          CSI sequences (ESC '[' parameters intermediates final), OSC strings (ESC ']' ... BEL or ST) and two byte
+ *          escapes.
+ *
+ * @param str           The bytes to scan
+ * @param length        The number of bytes to scan
+ * @param max_printable Stop once this many printable characters have been seen
+ * @param state         The escape state, carried between calls
+ * @param printable     The running printable character count
+ * @return size_t       The number of bytes consumed
+ */
+static size_t console_isprint_scan_scalar_internal(const char *str, size_t length, size_t max_printable, ConsoleEscapeState_e *state, size_t *printable)
+{
+    size_t i = 0;
+
+    while ((i < length) && (*printable < max_printable))
     {
-        console_settings->put_char_fn(c);
+        unsigned char c = (unsigned char)str[i++];
+
+        switch (*state)
+        {
+            case ESCAPE_STATE_NONE:
+                if (c == '\x1b')
+                {
+                    *state = ESCAPE_STATE_ESC;
+                }
+                else if ((c >= 0x20) && (c <= 0x7e))
+                {
+                    (*printable)++;
+                }
+                break;
+            case ESCAPE_STATE_ESC:
+                if (c == '[')
+                {
+                    *state = ESCAPE_STATE_CSI;
+                }
+                else if (c == ']')
+                {
+                    *state = ESCAPE_STATE_OSC;
+                }
+                else
+                {
+                    *state = ESCAPE_STATE_NONE;
+                }
+                break;
+            case ESCAPE_STATE_CSI:
+                /* Parameter and intermediate bytes keep us going, a final byte (or anything unexpected) ends it */
+                if ((c < 0x20) || (c > 0x3f))
+                {
+                    *state = (c == '\x1b') ? ESCAPE_STATE_ESC : ESCAPE_STATE_NONE;
+                }
+                break;
+            case ESCAPE_STATE_OSC:
+                if (c == '\a')
+                {
+                    *state = ESCAPE_STATE_NONE;
+                }
+                else if (c == '\x1b')
+                {
+                    *state = ESCAPE_STATE_ESC;
+                }
+                break;
+        }
     }
+
+    return i;
 }
 
-void console_put_string_internal(LoggingLevel_e logging_level, const char *string)
+#if defined(CONSOLE_SIMD_AVX2)
+/**
+ * @brief   AVX2 version of the plain text fast path, see console_isprint_span_len().
+ */
+__attribute__((target("avx2"))) static size_t console_isprint_scan_avx2_internal(const char *str, size_t length, size_t max_printable, size_t *printable)
 {
-    if (console_settings->logging_level >= logging_level)
+    const __m256i low  = _mm256_set1_epi8(0x20);
+    const __m256i high = _mm256_set1_epi8(0x7e);
+    const __m256i esc  = _mm256_set1_epi8(0x1b);
+    size_t        i    = 0;
+
+    while ((i + 32 <= length) && (*printable + 32 <= max_printable))
     {
-        console_settings->put_string_fn(string);
+        __m256i  chunk          = _mm256_loadu_si256((const __m256i *)&str[i]);
+        uint32_t escapes        = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, esc));
+        uint32_t non_printables = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpgt_epi8(low, chunk), _mm256_cmpgt_epi8(chunk, high)));
+
+        if (escapes)
+        {
+            /* Count up to the escape and let the scalar scanner deal with the sequence */
+            unsigned int before = (unsigned int)__builtin_ctz(escapes);
+            *printable += before - (unsigned int)__builtin_popcount(non_printables & ((1u << before) - 1));
+            return i + before;
+        }
+        *printable += 32 - (unsigned int)__builtin_popcount(non_printables);
+        i += 32;
     }
+
+    return i;
 }
+#endif /* defined(CONSOLE_SIMD_AVX2) */
 
-size_t console_isprint_str_len(const char *str)
+#if defined(CONSOLE_SIMD_SSE2)
+/**
+ * @brief   SSE2 version of the plain text fast path, see console_isprint_span_len().
+ */
+static size_t console_isprint_scan_sse2_internal(const char *str, size_t length, size_t max_printable, size_t *printable)
 {
-    size_t len                = 0;
-    bool   inside_escape_code = false;
+    const __m128i low  = _mm_set1_epi8(0x20);
+    const __m128i high = _mm_set1_epi8(0x7e);
+    const __m128i esc  = _mm_set1_epi8(0x1b);
+    size_t        i    = 0;
 
-    while (*str)
+    while ((i + 16 <= length) && (*printable + 16 <= max_printable))
     {
-        unsigned char c = *str;
-        if (c == '\x1b')
+        __m128i      chunk          = _mm_loadu_si128((const __m128i *)&str[i]);
+        unsigned int escapes        = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, esc));
+        unsigned int non_printables = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmplt_epi8(chunk, low), _mm_cmpgt_epi8(chunk, high)));
+
+        if (escapes)
         {
-            inside_escape_code = true;
+            /* Count up to the escape and let the scalar scanner deal with the sequence */
+            unsigned int before = (unsigned int)__builtin_ctz(escapes);
+            *printable += before - (unsigned int)__builtin_popcount(non_printables & ((1u << before) - 1));
+            return i + before;
         }
-        else if (inside_escape_code && ((c == 'm') || (c == 'J')))
+        *printable += 16 - (unsigned int)__builtin_popcount(non_printables);
+        i += 16;
+    }
+
+    return i;
+}
+#endif /* defined(CONSOLE_SIMD_SSE2) */
+
+/**
+ * @brief   Count the printable characters in a span of bytes, skipping ANSI escape sequences. Plain text between escape
+ *          sequences is counted 32 (AVX2) or 16 (SSE2) bytes at a time where available, escape sequences themselves go
+ *          through the scalar scanner.
+ *
+ * @param str           The bytes to scan
+ * @param length        The number of bytes to scan
+ * @param max_printable Stop once this many printable characters have been seen (SIZE_MAX to scan everything)
+ * @param consumed      If not NULL, set to the number of bytes scanned
+ * @return size_t       The number of printable characters
+ */
+size_t console_isprint_span_len(const char *str, size_t length, size_t max_printable, size_t *consumed)
+{
+    ConsoleEscapeState_e state     = ESCAPE_STATE_NONE;
+    size_t               printable = 0;
+    size_t               i         = 0;
+#if defined(CONSOLE_SIMD_AVX2)
+    static int has_avx2 = -1;
+
+    if (has_avx2 < 0)
+    {
+        has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+#endif /* defined(CONSOLE_SIMD_AVX2) */
+
+    while ((i < length) && (printable < max_printable))
+    {
+        /* Outside of escape sequences, skim over plain text in bulk */
+        if (state == ESCAPE_STATE_NONE)
         {
-            inside_escape_code = false;
+#if defined(CONSOLE_SIMD_AVX2)
+            if (has_avx2)
+            {
+                i += console_isprint_scan_avx2_internal(&str[i], length - i, max_printable, &printable);
+            }
+#endif /* defined(CONSOLE_SIMD_AVX2) */
+#if defined(CONSOLE_SIMD_SSE2)
+            i += console_isprint_scan_sse2_internal(&str[i], length - i, max_printable, &printable);
+#endif /* defined(CONSOLE_SIMD_SSE2) */
         }
-        else if (!inside_escape_code && isprint(c))
+
+        /* Handle at least one byte (and any escape sequence) the slow way, resuming the bulk scan once we're out. The
+         * bulk scan may have taken us to the end already. */
+        while ((i < length) && (printable < max_printable))
         {
-            ++len;
+            i += console_isprint_scan_scalar_internal(&str[i], 1, max_printable, &state, &printable);
+            if (state == ESCAPE_STATE_NONE)
+            {
+                break;
+            }
         }
-        ++str;
     }
 
-    return len;
+    if (consumed)
+    {
+        *consumed = i;
+    }
+
+    return printable;
 }
 
+size_t console_isprint_str_len(const char *str) { return console_isprint_span_len(str, strlen(str), SIZE_MAX, NULL); }
+
 void console_assert_warn(LoggingLevel_e logging_level, bool condition, const char *format, ...)
 {
-    if (!condition)
+    if (!condition && console_logging_enabled(logging_level))
     {
         char   *string_buffer = string_buffers[console_get_string_buffer_index()];
         va_list args;
         va_start(args, format);
-        vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
+        console_format_internal(string_buffer, format, args);
         va_end(args);
         console_print(logging_level, ANSI_COLOR_RED "Assert Warning: %s" ANSI_COLOR_RESET, string_buffer);
     }
@@ -938,12 +4888,15 @@ FunctionResult_e console_assert_error(LoggingLevel_e logging_level, bool conditi
 
     if (!condition)
     {
-        char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-        va_list args;
-        va_start(args, format);
-        vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-        va_end(args);
-        console_print(logging_level, ANSI_COLOR_RED "Assert Error: %s" ANSI_COLOR_RESET, string_buffer);
+        if (console_logging_enabled(logging_level))
+        {
+            char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+            va_list args;
+            va_start(args, format);
+            console_format_internal(string_buffer, format, args);
+            va_end(args);
+            console_print(logging_level, ANSI_COLOR_RED "Assert Error: %s" ANSI_COLOR_RESET, string_buffer);
+        }
         result = FR_FAIL;
     }
 
@@ -954,16 +4907,60 @@ void console_assert_fatal(LoggingLevel_e logging_level, bool condition, const ch
 {
     if (!condition)
     {
-        char   *string_buffer = string_buffers[console_get_string_buffer_index()];
-        va_list args;
-        va_start(args, format);
-        vsnprintf(string_buffer, STRING_BUFFER_SIZE, format, args);
-        va_end(args);
-        console_print(logging_level, ANSI_COLOR_RED "Assert Fatal: %s - Program exiting!" ANSI_COLOR_RESET, string_buffer);
+        if (console_logging_enabled(logging_level))
+        {
+            char   *string_buffer = string_buffers[console_get_string_buffer_index()];
+            va_list args;
+            va_start(args, format);
+            console_format_internal(string_buffer, format, args);
+            va_end(args);
+            console_print(logging_level, ANSI_COLOR_RED "Assert Fatal: %s - Program exiting!" ANSI_COLOR_RESET, string_buffer);
+        }
+        console_exit_flush_internal();
         exit(FR_FAIL);
     }
 }
 
+/**
+ * @brief   Print a run of the same padding character as spans rather than one character at a time.
+ *
+ * @param logging_level The logging level for the print
+ * @param c             The padding character, one of ' ', '.', '-' or '='
+ * @param count         The number of characters to print
+ */
+void console_print_padding_internal(LoggingLevel_e logging_level, char c, size_t count)
+{
+    static const char spaces[] = "                                                                                                                                ";
+    static const char dots[]   = "................................................................................................................................";
+    static const char dashes[] = "--------------------------------------------------------------------------------------------------------------------------------";
+    static const char equals[] = "================================================================================================================================";
+    const char       *span;
+
+    switch (c)
+    {
+        case '.':
+            span = dots;
+            break;
+        case '-':
+            span = dashes;
+            break;
+        case '=':
+            span = equals;
+            break;
+        case ' ':
+        default:
+            span = spaces;
+            break;
+    }
+
+    while (count)
+    {
+        size_t length = (count > (sizeof(spaces) - 1)) ? (sizeof(spaces) - 1) : count;
+        console_write_internal(logging_level, span, length);
+        count -= length;
+    }
+}
+
 /**
  * @brief   This utility prints a table divider for use with the table printer
  *
@@ -975,13 +4972,123 @@ void console_print_table_divider(LoggingLevel_e logging_level, size_t *column_wi
 {
     for (int i = 0; i < num_columns; i++)
     {
-        console_print_no_eol(logging_level, "+");
-        for (size_t j = 0; j < column_widths[i] + 1; j++)
-        {
-            console_print_no_eol(logging_level, "-");
-        }
+        console_put_char_internal(logging_level, '+');
+        console_print_padding_internal(logging_level, '-', column_widths[i] + 1);
+    }
+    console_put_char_internal(logging_level, '+');
+    console_print_new_line(logging_level);
+}
+
+/* "00" through "99", so decimal conversion can emit two digits per division */
+static const char console_digit_pairs[201] = "00010203040506070809"
+                                             "10111213141516171819"
+                                             "20212223242526272829"
+                                             "30313233343536373839"
+                                             "40414243444546474849"
+                                             "50515253545556575859"
+                                             "60616263646566676869"
+                                             "70717273747576777879"
+                                             "80818283848586878889"
+                                             "90919293949596979899";
+
+static const char console_hex_digits[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+/**
+ * @brief   Copy a span into a buffer, truncating and terminating it the way snprintf() would.
+ *
+ * @param buffer    The string buffer to write into
+ * @param buff_size The string buffer size
+ * @param span      The bytes to copy
+ * @param length    The number of bytes to copy
+ */
+static void console_sprint_span_internal(char *buffer, size_t buff_size, const char *span, size_t length)
+{
+    if (buff_size == 0)
+    {
+        return;
+    }
+
+    if (length >= buff_size)
+    {
+        length = buff_size - 1;
+    }
+    memcpy(buffer, span, length);
+    buffer[length] = '\0';
+}
+
+/**
+ * @brief   Format an integer in decimal, same output as the PRId and PRIu formats.
+ *
+ * @param buffer    The string buffer to write into
+ * @param buff_size The string buffer size
+ * @param negative  Whether value holds a negative number (in two's complement)
+ * @param value     The value to format
+ */
+static void console_sprint_dec_internal(char *buffer, size_t buff_size, bool negative, uint64_t value)
+{
+    char  digits[21]; /* 20 digits for UINT64_MAX, plus a sign */
+    char *cursor = &digits[sizeof(digits)];
+
+    if (negative)
+    {
+        value = 0 - value;
+    }
+
+    /* Work backwards from the least significant end, two digits at a time */
+    while (value >= 100)
+    {
+        unsigned int pair = (unsigned int)(value % 100) * 2;
+        value /= 100;
+        *--cursor = console_digit_pairs[pair + 1];
+        *--cursor = console_digit_pairs[pair];
+    }
+    if (value >= 10)
+    {
+        *--cursor = console_digit_pairs[value * 2 + 1];
+        *--cursor = console_digit_pairs[value * 2];
+    }
+    else
+    {
+        *--cursor = (char)('0' + value);
+    }
+
+    if (negative)
+    {
+        *--cursor = '-';
+    }
+
+    console_sprint_span_internal(buffer, buff_size, cursor, (size_t)(&digits[sizeof(digits)] - cursor));
+}
+
+/**
+ * @brief   Format an integer in hex with a leading 0x, padded with zeros to at least min_digits, same output as the
+ *          "0x%0<n>" PRIx formats.
+ *
+ * @param buffer     The string buffer to write into
+ * @param buff_size  The string buffer size
+ * @param value      The value to format
+ * @param min_digits The minimum number of hex digits to print
+ */
+static void console_sprint_hex_internal(char *buffer, size_t buff_size, uint64_t value, size_t min_digits)
+{
+    char   digits[18] = {'0', 'x'};
+    size_t num_digits = 1;
+
+    /* Count the significant nibbles, then fill them in one lookup each */
+    while ((num_digits < 16) && (value >> (num_digits * 4)))
+    {
+        num_digits++;
+    }
+    if (num_digits < min_digits)
+    {
+        num_digits = min_digits;
+    }
+    for (size_t i = 0; i < num_digits; i++)
+    {
+        digits[1 + num_digits - i] = console_hex_digits[(value >> (i * 4)) & 0xf];
     }
-    console_print(logging_level, "+");
+
+    console_sprint_span_internal(buffer, buff_size, digits, num_digits + 2);
 }
 
 /**
@@ -1054,6 +5161,9 @@ void console_sprint_table_format_entry(char *buffer, size_t buff_size, TypeEnum_
 
     if (!skip_snprintf)
     {
+        char  *cell      = buffer + offset;
+        size_t cell_size = updated_buff_size;
+
         switch (type)
         {
             case TYPE_NONE:
@@ -1062,50 +5172,73 @@ void console_sprint_table_format_entry(char *buffer, size_t buff_size, TypeEnum_
             case TYPE_BOOL_NUM:
                 if (((bool *)data)[index])
                 {
-                    snprintf(buffer + offset, updated_buff_size, ANSI_COLOR_RESET ANSI_COLOR_CYAN "1" ANSI_COLOR_RESET);
+                    console_sprint_span_internal(cell, cell_size, ANSI_COLOR_RESET ANSI_COLOR_CYAN "1" ANSI_COLOR_RESET, sizeof(ANSI_COLOR_RESET ANSI_COLOR_CYAN "1" ANSI_COLOR_RESET) - 1);
                 }
                 else
                 {
-                    snprintf(buffer + offset, updated_buff_size, ANSI_COLOR_RESET ANSI_COLOR_MAGENTA "0" ANSI_COLOR_RESET);
+                    console_sprint_span_internal(cell, cell_size, ANSI_COLOR_RESET ANSI_COLOR_MAGENTA "0" ANSI_COLOR_RESET, sizeof(ANSI_COLOR_RESET ANSI_COLOR_MAGENTA "0" ANSI_COLOR_RESET) - 1);
                 }
                 break;
             case TYPE_BOOL_WORD:
                 if (((bool *)data)[index])
                 {
-                    snprintf(buffer + offset, updated_buff_size, ANSI_COLOR_RESET ANSI_COLOR_CYAN "true" ANSI_COLOR_RESET);
+                    console_sprint_span_internal(cell, cell_size, ANSI_COLOR_RESET ANSI_COLOR_CYAN "true" ANSI_COLOR_RESET, sizeof(ANSI_COLOR_RESET ANSI_COLOR_CYAN "true" ANSI_COLOR_RESET) - 1);
                 }
                 else
                 {
-                    snprintf(buffer + offset, updated_buff_size, ANSI_COLOR_RESET ANSI_COLOR_MAGENTA "false" ANSI_COLOR_RESET);
+                    console_sprint_span_internal(cell, cell_size, ANSI_COLOR_RESET ANSI_COLOR_MAGENTA "false" ANSI_COLOR_RESET, sizeof(ANSI_COLOR_RESET ANSI_COLOR_MAGENTA "false" ANSI_COLOR_RESET) - 1);
                 }
                 break;
             case TYPE_CHAR:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((char *)data)[index]);
+                snprintf(cell, cell_size, console_type_lut[type].format_string, ((char *)data)[index]);
                 break;
             case TYPE_STRING:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((char **)data)[index]);
+                console_sprint_span_internal(cell, cell_size, ((char **)data)[index], strlen(((char **)data)[index]));
                 break;
             case TYPE_FLOAT:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((float *)data)[index]);
+                snprintf(cell, cell_size, console_type_lut[type].format_string, ((float *)data)[index]);
                 break;
+            /* Integers skip the printf machinery entirely, see console_sprint_dec_internal() and console_sprint_hex_internal() */
             case TYPE_DEC_INT8:
+                console_sprint_dec_internal(cell, cell_size, ((int8_t *)data)[index] < 0, (uint64_t)((int8_t *)data)[index]);
+                break;
+            case TYPE_DEC_INT16:
+                console_sprint_dec_internal(cell, cell_size, ((int16_t *)data)[index] < 0, (uint64_t)((int16_t *)data)[index]);
+                break;
+            case TYPE_DEC_INT32:
+                console_sprint_dec_internal(cell, cell_size, ((int32_t *)data)[index] < 0, (uint64_t)((int32_t *)data)[index]);
+                break;
+            case TYPE_DEC_INT64:
+                console_sprint_dec_internal(cell, cell_size, ((int64_t *)data)[index] < 0, (uint64_t)((int64_t *)data)[index]);
+                break;
+            case TYPE_DEC_UINT8:
+                console_sprint_dec_internal(cell, cell_size, false, ((uint8_t *)data)[index]);
+                break;
+            case TYPE_DEC_UINT16:
+                console_sprint_dec_internal(cell, cell_size, false, ((uint16_t *)data)[index]);
+                break;
+            case TYPE_DEC_UINT32:
+                console_sprint_dec_internal(cell, cell_size, false, ((uint32_t *)data)[index]);
+                break;
+            case TYPE_DEC_UINT64:
+                console_sprint_dec_internal(cell, cell_size, false, ((uint64_t *)data)[index]);
+                break;
+            /* Signed values up to 32 bits are promoted to int on their way through printf's %x, so sign extend them to 32
+            bits to print the same thing */
             case TYPE_HEX_INT4:
             case TYPE_HEX_INT8:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((int8_t *)data)[index]);
+                console_sprint_hex_internal(cell, cell_size, (uint32_t)((int8_t *)data)[index], console_type_lut[type].hex_digits);
                 break;
-            case TYPE_DEC_INT16:
             case TYPE_HEX_INT12:
             case TYPE_HEX_INT16:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((int16_t *)data)[index]);
+                console_sprint_hex_internal(cell, cell_size, (uint32_t)((int16_t *)data)[index], console_type_lut[type].hex_digits);
                 break;
-            case TYPE_DEC_INT32:
             case TYPE_HEX_INT20:
             case TYPE_HEX_INT24:
             case TYPE_HEX_INT28:
             case TYPE_HEX_INT32:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((int32_t *)data)[index]);
+                console_sprint_hex_internal(cell, cell_size, (uint32_t)((int32_t *)data)[index], console_type_lut[type].hex_digits);
                 break;
-            case TYPE_DEC_INT64:
             case TYPE_HEX_INT36:
             case TYPE_HEX_INT40:
             case TYPE_HEX_INT44:
@@ -1114,26 +5247,22 @@ void console_sprint_table_format_entry(char *buffer, size_t buff_size, TypeEnum_
             case TYPE_HEX_INT56:
             case TYPE_HEX_INT60:
             case TYPE_HEX_INT64:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((int64_t *)data)[index]);
+                console_sprint_hex_internal(cell, cell_size, (uint64_t)((int64_t *)data)[index], console_type_lut[type].hex_digits);
                 break;
-            case TYPE_DEC_UINT8:
             case TYPE_HEX_UINT4:
             case TYPE_HEX_UINT8:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((uint8_t *)data)[index]);
+                console_sprint_hex_internal(cell, cell_size, ((uint8_t *)data)[index], console_type_lut[type].hex_digits);
                 break;
-            case TYPE_DEC_UINT16:
             case TYPE_HEX_UINT12:
             case TYPE_HEX_UINT16:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((uint16_t *)data)[index]);
+                console_sprint_hex_internal(cell, cell_size, ((uint16_t *)data)[index], console_type_lut[type].hex_digits);
                 break;
-            case TYPE_DEC_UINT32:
             case TYPE_HEX_UINT20:
             case TYPE_HEX_UINT24:
             case TYPE_HEX_UINT28:
             case TYPE_HEX_UINT32:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((uint32_t *)data)[index]);
+                console_sprint_hex_internal(cell, cell_size, ((uint32_t *)data)[index], console_type_lut[type].hex_digits);
                 break;
-            case TYPE_DEC_UINT64:
             case TYPE_HEX_UINT36:
             case TYPE_HEX_UINT40:
             case TYPE_HEX_UINT44:
@@ -1142,7 +5271,7 @@ void console_sprint_table_format_entry(char *buffer, size_t buff_size, TypeEnum_
             case TYPE_HEX_UINT56:
             case TYPE_HEX_UINT60:
             case TYPE_HEX_UINT64:
-                snprintf(buffer + offset, updated_buff_size, console_type_lut[type].format_string, ((uint64_t *)data)[index]);
+                console_sprint_hex_internal(cell, cell_size, ((uint64_t *)data)[index], console_type_lut[type].hex_digits);
                 break;
             default:
                 console_print_error(LOGGING_LEVEL_0, "%s: Unsupported value of TypeEnum_e detected! (%d)", __FUNCTION__, type);
@@ -1172,7 +5301,9 @@ TableCellOptions_t *console_get_table_cell_options_array(int num_rows, TableCell
 }
 
 /**
- * @brief   This utility prints a table, constructed using TableColumn_t structs that make up the table.
+ * @brief   This utility prints a table, constructed using TableColumn_t structs that make up the table. Every cell is
+ *          formatted exactly once into an arena along with its printable length, the widths are worked out from those,
+ *          and then rows, padding and dividers are written out as whole spans.
  *
  * @param logging_level     The logging level for the print
  * @param num_rows          The number of rows of the table
@@ -1181,104 +5312,398 @@ TableCellOptions_t *console_get_table_cell_options_array(int num_rows, TableCell
  */
 void console_print_table(LoggingLevel_e logging_level, int num_rows, int num_columns, ...)
 {
-    char    buffer[STRING_BUFFER_SIZE];
-    va_list args;
+    if (!console_logging_enabled(logging_level))
+    {
+        return;
+    }
 
-    /* Prepare to calculate the maximum size of each column */
-    size_t *column_widths = (size_t *)malloc(sizeof(size_t) * num_columns);
-    memset(column_widths, 0, sizeof(size_t) * num_columns);
+    va_list         args;
+    size_t          num_cells     = (size_t)num_rows * (size_t)num_columns;
+    TableColumn_t **table_columns = (TableColumn_t **)malloc(sizeof(TableColumn_t *) * num_columns);
+    size_t         *column_widths = (size_t *)calloc(num_columns, sizeof(size_t));
+    size_t         *cell_offsets  = (size_t *)malloc(sizeof(size_t) * (num_cells + 1));
+    size_t         *cell_lengths  = (size_t *)malloc(sizeof(size_t) * (num_cells + 1));
+    size_t          arena_size    = STRING_BUFFER_SIZE * 4;
+    size_t          arena_used    = 0;
+    char           *arena         = (char *)malloc(arena_size);
+
+    if (!table_columns || !column_widths || !cell_offsets || !cell_lengths || !arena)
+    {
+        console_print_error(LOGGING_LEVEL_0, "%s: Out of memory!", __FUNCTION__);
+        goto cleanup;
+    }
 
-    /* Start args to calculate the maximum length of each column's content. */
-    /* All calculations add + 1 so that we have some padding. */
+    /* Grab the columns once */
     va_start(args, num_columns);
     for (int i = 0; i < num_columns; i++)
     {
-        TableColumn_t *table_column = va_arg(args, TableColumn_t *);
-        if (!table_column)
+        table_columns[i] = va_arg(args, TableColumn_t *);
+        if (!table_columns[i])
         {
             console_print_error(LOGGING_LEVEL_0, "%s: table_column pointer is null!", __FUNCTION__);
-            break;
+            va_end(args);
+            goto cleanup;
         }
+    }
+    va_end(args);
+
+    /* Format every cell once, keeping its printable length. All widths add + 1 so that we have some padding. */
+    for (int i = 0; i < num_columns; i++)
+    {
+        TableColumn_t *table_column  = table_columns[i];
+        size_t         header_length = console_isprint_str_len(table_column->header);
 
-        /* Header width */
-        if (console_isprint_str_len(table_column->header) > column_widths[i])
+        if (header_length > column_widths[i])
         {
-            column_widths[i] = console_isprint_str_len(table_column->header) + 1;
+            column_widths[i] = header_length + 1;
         }
-        /* Column content widths. We calculate the widths by actually formatting and then taking the lengths. */
         for (int j = 0; j < num_rows; j++)
         {
-            console_sprint_table_format_entry(buffer, sizeof(buffer), table_column->type, table_column->values, table_column->options, j);
+            size_t cell = ((size_t)j * num_columns) + i;
+
+            /* Make sure a whole formatted entry fits in the arena */
+            if (arena_size - arena_used < STRING_BUFFER_SIZE)
+            {
+                char *new_arena = (char *)realloc(arena, arena_size * 2);
+                if (!new_arena)
+                {
+                    console_print_error(LOGGING_LEVEL_0, "%s: Out of memory!", __FUNCTION__);
+                    goto cleanup;
+                }
+                arena = new_arena;
+                arena_size *= 2;
+            }
+
+            console_sprint_table_format_entry(&arena[arena_used], STRING_BUFFER_SIZE, table_column->type, table_column->values, table_column->options, j);
+            cell_offsets[cell] = arena_used;
+            cell_lengths[cell] = console_isprint_str_len(&arena[arena_used]);
+            arena_used += strlen(&arena[arena_used]) + 1;
 
-            if (console_isprint_str_len(buffer) + 1 > column_widths[i])
+            if (cell_lengths[cell] + 1 > column_widths[i])
             {
-                column_widths[i] = console_isprint_str_len(buffer) + 1;
+                column_widths[i] = cell_lengths[cell] + 1;
             }
         }
     }
-    va_end(args);
 
     /* Print divider */
     console_print_table_divider(logging_level, column_widths, num_columns);
 
     /* Print headers */
-    va_start(args, num_columns);
     for (int i = 0; i < num_columns; i++)
     {
-        TableColumn_t *table_column = va_arg(args, TableColumn_t *);
-        console_print_no_eol(logging_level, "| %-*s", column_widths[i], table_column->header);
+        console_put_string_internal(logging_level, "| ");
+        console_put_string_internal(logging_level, table_columns[i]->header);
+        console_print_padding_internal(logging_level, ' ', column_widths[i] - console_isprint_str_len(table_columns[i]->header));
     }
-    console_print(logging_level, "|");
-    va_end(args);
+    console_put_char_internal(logging_level, '|');
+    console_print_new_line(logging_level);
 
     /* Print divider */
     console_print_table_divider(logging_level, column_widths, num_columns);
 
     /* Print row labels and corresponding column values */
-    va_start(args, num_columns);
     for (int i = 0; i < num_rows; i++)
     {
         for (int j = 0; j < num_columns; j++)
         {
-            TableColumn_t *table_column = va_arg(args, TableColumn_t *);
+            TableColumn_t *table_column = table_columns[j];
+            size_t         cell         = ((size_t)i * num_columns) + j;
+            bool           print_dots   = !(table_column->options && (table_column->options[i].options & TABLE_CELL_OPTIONS_NO_DOTS));
 
-            console_print_no_eol(logging_level, "| ");
+            console_put_string_internal(logging_level, "| ");
+            console_put_string_internal(logging_level, &arena[cell_offsets[cell]]);
+            if (cell_lengths[cell] < column_widths[j])
+            {
+                console_print_padding_internal(logging_level, print_dots ? '.' : ' ', column_widths[j] - cell_lengths[cell]);
+            }
+        }
+        console_put_char_internal(logging_level, '|');
+        console_print_new_line(logging_level);
+    }
 
-            console_sprint_table_format_entry(buffer, sizeof(buffer), table_column->type, table_column->values, table_column->options, i);
+    /* Print divider */
+    console_print_table_divider(logging_level, column_widths, num_columns);
 
-            console_print_no_eol(logging_level, "%s", buffer);
+cleanup:
+    free(arena);
+    free(cell_lengths);
+    free(cell_offsets);
+    free(column_widths);
+    free(table_columns);
+}
 
-            bool print_dots = true;
-            for (size_t k = console_isprint_str_len(buffer); k < column_widths[j]; k++)
+/**
+ * @brief   Check whether an escape sequence is complete within a number of bytes, following the same rules as
+ *          console_isprint_span_len().
+ *
+ * @param escape    The escape sequence, starting with its ESC
+ * @param length    The number of bytes available
+ * @return true     The sequence ends within length bytes
+ */
+static bool console_escape_complete_internal(const char *escape, size_t length)
+{
+    if (length < 2)
+    {
+        return false;
+    }
+    if (escape[1] == '[')
+    {
+        for (size_t i = 2; i < length; i++)
+        {
+            if (((unsigned char)escape[i] < 0x20) || ((unsigned char)escape[i] > 0x3f))
             {
-                if (table_column->options)
-                {
-                    if ((table_column->options[i].options & TABLE_CELL_OPTIONS_NO_DOTS))
-                    {
-                        print_dots = false;
-                    }
-                }
+                return true;
+            }
+        }
+        return false;
+    }
+    if (escape[1] == ']')
+    {
+        return memchr(&escape[2], '\a', length - 2) != NULL;
+    }
+
+    return true;
+}
+
+/**
+ * @brief   Cut a formatted cell down to a number of printable characters, keeping any escape sequences intact and
+ *          marking the cut with a '~' followed by ANSI_COLOR_RESET.
+ *
+ * @param cell          The formatted cell
+ * @param cell_size     The size of the cell's buffer
+ * @param max_printable The maximum number of printable characters to keep, including the '~'
+ * @return size_t       The number of printable characters left in the cell
+ */
+static size_t console_truncate_cell_internal(char *cell, size_t cell_size, size_t max_printable)
+{
+    size_t length = strlen(cell);
+    size_t limit;
+    size_t printable;
+    size_t cut;
+
+    /* The cut has to leave room for the '~', the reset and the NUL */
+    if ((max_printable == 0) || (cell_size < sizeof(ANSI_COLOR_RESET) + 1))
+    {
+        cell[0] = '\0';
+        return 0;
+    }
+    limit = cell_size - sizeof(ANSI_COLOR_RESET) - 1;
 
-                if (print_dots)
+    /* Keep everything up to the last printable character that fits, the '~' takes the place of the next one */
+    printable = console_isprint_span_len(cell, length, max_printable - 1, &cut);
+    if (console_isprint_span_len(&cell[cut], length - cut, SIZE_MAX, NULL) <= 1)
+    {
+        return console_isprint_span_len(cell, length, SIZE_MAX, NULL);
+    }
+
+    /* A cell heavy on escape sequences may not have room for the marker there, cut sooner without splitting a sequence */
+    if (cut > limit)
+    {
+        cut = limit;
+        for (size_t i = cut; i-- > 0;)
+        {
+            if (cell[i] == '\x1b')
+            {
+                if (!console_escape_complete_internal(&cell[i], cut - i))
                 {
-                    console_print_no_eol(logging_level, ".");
+                    cut = i;
                 }
-                else
+                break;
+            }
+        }
+        printable = console_isprint_span_len(cell, cut, SIZE_MAX, NULL);
+    }
+
+    cell[cut] = '~';
+    strcpy(&cell[cut + 1], ANSI_COLOR_RESET);
+
+    return printable + 1;
+}
+
+/**
+ * @brief   Print one streamed table row from its formatted cells.
+ *
+ * @param logging_level     The logging level for the print
+ * @param stream            The table stream
+ * @param cells             The formatted cells, STRING_BUFFER_SIZE apart
+ * @param options           The cells' options
+ * @param column_widths     The widths of each column
+ */
+static void console_print_table_stream_row_internal(LoggingLevel_e logging_level, TableStream_t *stream, char *cells, TableCellOptions_t *options, size_t *column_widths)
+{
+    for (int i = 0; i < stream->num_columns; i++)
+    {
+        char  *cell   = &cells[i * STRING_BUFFER_SIZE];
+        size_t length = console_isprint_str_len(cell);
+
+        /* Columns keep one character of padding, anything longer than that overflows */
+        if ((length + 1 > column_widths[i]) && (stream->overflow_policy == TABLE_OVERFLOW_TRUNCATE))
+        {
+            length = console_truncate_cell_internal(cell, STRING_BUFFER_SIZE, column_widths[i] - 1);
+        }
+
+        console_put_string_internal(logging_level, "| ");
+        console_put_string_internal(logging_level, cell);
+        if (length < column_widths[i])
+        {
+            console_print_padding_internal(logging_level, (options[i].options & TABLE_CELL_OPTIONS_NO_DOTS) ? ' ' : '.', column_widths[i] - length);
+        }
+    }
+    console_put_char_internal(logging_level, '|');
+    console_print_new_line(logging_level);
+}
+
+/**
+ * @brief   Fetch and format the next row of a streamed table.
+ *
+ * @param stream    The table stream
+ * @param row       The index of the row to fetch
+ * @param values    Scratch array of value pointers, one per column
+ * @param options   The cells' options, one per column
+ * @param cells     Where to format the cells, STRING_BUFFER_SIZE apart
+ * @return true     A row was fetched
+ * @return false    There are no more rows
+ */
+static bool console_fetch_table_stream_row_internal(TableStream_t *stream, unsigned long row, void **values, TableCellOptions_t *options, char *cells)
+{
+    memset(values, 0, sizeof(void *) * stream->num_columns);
+    memset(options, 0, sizeof(TableCellOptions_t) * stream->num_columns);
+
+    if (!stream->fetch_row(stream->context, row, values, options))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < stream->num_columns; i++)
+    {
+        if (values[i])
+        {
+            console_sprint_table_format_entry(&cells[i * STRING_BUFFER_SIZE], STRING_BUFFER_SIZE, stream->columns[i].type, values[i], &options[i], 0);
+        }
+        else
+        {
+            cells[i * STRING_BUFFER_SIZE] = '\0';
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief   This utility prints a table whose rows are supplied one at a time by a callback, for tables too large (or too
+ *          live) to hold in memory. Columns either have a fixed width or have it estimated from the first sample_rows
+ *          rows, which are the only rows ever buffered. Output starts as soon as the sample is in and memory use does
+ *          not depend on the number of rows.
+ *
+ * @param logging_level     The logging level for the print
+ * @param stream            The table stream describing the columns and supplying the rows
+ * @return unsigned long    The number of rows printed
+ */
+unsigned long console_print_table_stream(LoggingLevel_e logging_level, TableStream_t *stream)
+{
+    if (!console_logging_enabled(logging_level))
+    {
+        return 0;
+    }
+
+    int                 num_columns   = stream->num_columns;
+    unsigned long       num_rows      = 0;
+    unsigned long       num_sampled   = 0;
+    bool                more_rows     = true;
+    uint64_t            last_flush    = 0;
+    size_t             *column_widths = (size_t *)calloc(num_columns, sizeof(size_t));
+    void              **values        = (void **)malloc(sizeof(void *) * num_columns);
+    TableCellOptions_t *options       = (TableCellOptions_t *)malloc(sizeof(TableCellOptions_t) * num_columns * (stream->sample_rows + 1));
+    char               *cells         = (char *)malloc((size_t)STRING_BUFFER_SIZE * num_columns * (stream->sample_rows + 1));
+
+    if (!column_widths || !values || !options || !cells || !stream->fetch_row)
+    {
+        console_print_error(LOGGING_LEVEL_0, "%s: Out of memory or no row fetcher!", __FUNCTION__);
+        goto cleanup;
+    }
+
+    /* Columns start out as wide as their header or their fixed width. All widths add + 1 so that we have some padding. */
+    for (int i = 0; i < num_columns; i++)
+    {
+        column_widths[i] = stream->columns[i].width ? stream->columns[i].width : console_isprint_str_len(stream->columns[i].header);
+        column_widths[i] += 1;
+    }
+
+    /* Sample the first rows to estimate the widths of the columns without a fixed width */
+    while ((num_sampled < stream->sample_rows) && more_rows)
+    {
+        char               *row_cells   = &cells[num_sampled * STRING_BUFFER_SIZE * num_columns];
+        TableCellOptions_t *row_options = &options[num_sampled * num_columns];
+
+        more_rows = console_fetch_table_stream_row_internal(stream, num_sampled, values, row_options, row_cells);
+        if (more_rows)
+        {
+            for (int i = 0; i < num_columns; i++)
+            {
+                size_t length = console_isprint_str_len(&row_cells[i * STRING_BUFFER_SIZE]);
+                if (!stream->columns[i].width && (length + 1 > column_widths[i]))
                 {
-                    console_print_no_eol(logging_level, " ");
+                    column_widths[i] = length + 1;
                 }
             }
+            num_sampled++;
         }
-        console_print(logging_level, "|");
+    }
 
-        /* reset args to the beginning */
-        va_end(args);
-        va_start(args, num_columns);
+    /* Headers */
+    console_print_table_divider(logging_level, column_widths, num_columns);
+    for (int i = 0; i < num_columns; i++)
+    {
+        char   header[STRING_BUFFER_SIZE];
+        size_t length;
+
+        snprintf(header, sizeof(header), "%s", stream->columns[i].header);
+        length = console_isprint_str_len(header);
+        if (length + 1 > column_widths[i])
+        {
+            length = console_truncate_cell_internal(header, sizeof(header), column_widths[i] - 1);
+        }
+        console_put_string_internal(logging_level, "| ");
+        console_put_string_internal(logging_level, header);
+        console_print_padding_internal(logging_level, ' ', column_widths[i] - length);
+    }
+    console_put_char_internal(logging_level, '|');
+    console_print_new_line(logging_level);
+    console_print_table_divider(logging_level, column_widths, num_columns);
+
+    /* Sampled rows */
+    for (num_rows = 0; num_rows < num_sampled; num_rows++)
+    {
+        console_print_table_stream_row_internal(logging_level, stream, &cells[num_rows * STRING_BUFFER_SIZE * num_columns], &options[num_rows * num_columns], column_widths);
+    }
+    console_flush();
+    last_flush = console_get_time_ns();
+
+    /* Everything else streams through the first row slot */
+    while (more_rows && console_fetch_table_stream_row_internal(stream, num_rows, values, options, cells))
+    {
+        uint64_t now;
+
+        console_print_table_stream_row_internal(logging_level, stream, cells, options, column_widths);
+        num_rows++;
+
+        /* Slow streams get each row out as it arrives, fast ones are batched by the output buffer */
+        now = console_get_time_ns();
+        if (now - last_flush >= TABLE_STREAM_FLUSH_NS)
+        {
+            console_flush();
+            last_flush = now;
+        }
     }
-    va_end(args);
 
-    /* Print divider */
     console_print_table_divider(logging_level, column_widths, num_columns);
 
+cleanup:
+    free(cells);
+    free(options);
+    free(values);
     free(column_widths);
-}
\ No newline at end of file
+
+    return num_rows;
+}
@@ -59,6 +59,7 @@ typedef enum ConsoleMenuMode
 {
     MENU_DEFAULT = 0, // Default menu behavior, immutable definition
     MENU_MUTABLE = 1, // Menu is dynamically populated, consider it mutable
+    MENU_VIRTUAL = 2, // Menu items are fetched a page at a time from page_provider, menu_items is unused
 } ConsoleMenuMode_e;
 
 typedef enum ConsoleOptionFlags
@@ -76,6 +77,13 @@ typedef enum LoggingLevel
     LOGGING_LEVEL_3        = 3,
 } LoggingLevel_e;
 
+typedef enum ConsoleAsyncOverflow
+{
+    ASYNC_OVERFLOW_BLOCK       = 0, // Producers wait until the writer makes room
+    ASYNC_OVERFLOW_DROP_NEWEST = 1, // The message (line) being queued is dropped
+    ASYNC_OVERFLOW_DROP_OLDEST = 2, // The oldest queued message (line) is dropped to make room
+} ConsoleAsyncOverflow_e;
+
 typedef enum TypeEnum
 {
     TYPE_NONE = 0,
@@ -132,6 +140,7 @@ typedef struct TypeLookupTableEntry
     TypeEnum_e  type_enum;
     const char *format_string;
     size_t      size;
+    size_t      hex_digits; /* Minimum number of hex digits printed, 0 for non-hex types */
 } TypeLookupTableEntry_t;
 
 extern TypeLookupTableEntry_t console_type_lut[TYPE_MAX];
@@ -152,9 +161,24 @@ extern TypeLookupTableEntry_t console_type_lut[TYPE_MAX];
 #define TEXT_BLOCK_SIZE             (CONSOLE_WIDTH - 40)
 #define STRING_BUFFER_SIZE          (1024)
 #define NUM_STRING_BUFFERS          (50)
+#define OUTPUT_BUFFER_SIZE          (4096) ///< Output is batched up to this many bytes before being flushed to the sink
+#define ASYNC_RECORD_SIZE           (256)  ///< Maximum number of bytes carried by a single asynchronous logging record
+#define BINLOG_ARGS_SIZE            (96)   ///< Maximum number of raw argument bytes carried by a binary log record
+#define MENU_PATH_SEPARATOR         ('/')  ///< Separates the names in a menu path, e.g. "Main Menu/Sub Menu/Hello"
+#define MENU_PATH_MAX_LENGTH        (256)  ///< Maximum length of an indexed menu path
+#define MENU_PATH_MAX_DEPTH         (16)   ///< Menus nested deeper than this aren't indexed
+#define BINLOG_FILE_MAGIC           "UCBL" ///< Magic bytes at the start of a binary log dump
+#define BINLOG_FILE_VERSION         (1)    ///< Version of the binary log dump format
+#define BINLOG_FILE_TAG_FORMAT      ('F')  ///< Dump entry defining a format string: u32 id, u16 length, characters
+#define BINLOG_FILE_TAG_RECORD      ('R')  ///< Dump entry for a record: u32 format id, u64 timestamp, i8 level, u16 size, args
 #define HEADER_TITLE_EXTRAS_WIDTH   (6) ///< "=[  ]=" = 6 characters
 #define MAX_HEADER_TITLE_WIDTH      (CONSOLE_WIDTH - HEADER_TITLE_EXTRAS_WIDTH)
 #define MAX_TABLE_COL_CHAR_WIDTH    ((50) + 1)
+#define TABLE_STREAM_FLUSH_NS       (50000000) ///< Streamed table rows are flushed at least this often (ns)
+#define DASHBOARD_MAX_CELLS         (8)        ///< Maximum number of cells on a single dashboard line
+#define DASHBOARD_CELL_SIZE         (64)       ///< Maximum number of bytes in a dashboard cell (including NUL)
+#define MENU_SEARCH_QUERY_LENGTH    (64)       ///< Maximum length of a menu search query
+#define MENU_MOST_USED_MAX          (5)        ///< Maximum number of items in a menu's most used section ('A' to 'E')
 #define PAGE_LENGTH                 (10) ///< Maximum length of a page (0-9)
 #define FIRST_PAGE                  (0)  ///< Pages are zero indexed
 
@@ -166,6 +190,29 @@ extern TypeLookupTableEntry_t console_type_lut[TYPE_MAX];
     (void)(argv); /* To avoid [-Werror=unused-parameter] when implementing FunctionResult_e Function(int argc, char *argv[]) function types */
 #define IGNORE_UNUSED_ARG(x) (void)(x)
 
+/* Compile-time logging ceiling, logging calls made through the macros below above this level are compiled out */
+#ifndef CONSOLE_MAX_LOGGING_LEVEL
+#define CONSOLE_MAX_LOGGING_LEVEL LOGGING_LEVEL_3
+#endif
+
+/* Logging front-ends that skip formatting and argument evaluation entirely when the logging level is filtered */
+#define CONSOLE_LOG(print_fn, logging_level, ...)                                                              \
+    do                                                                                                         \
+    {                                                                                                          \
+        if (((logging_level) <= CONSOLE_MAX_LOGGING_LEVEL) && console_logging_enabled(logging_level))          \
+        {                                                                                                      \
+            print_fn((logging_level), __VA_ARGS__);                                                            \
+        }                                                                                                      \
+    } while (0)
+#define CONSOLE_PRINT(logging_level, ...)              CONSOLE_LOG(console_print, logging_level, __VA_ARGS__)
+#define CONSOLE_PRINT_NO_EOL(logging_level, ...)       CONSOLE_LOG(console_print_no_eol, logging_level, __VA_ARGS__)
+#define CONSOLE_PRINT_DEBUG(logging_level, ...)        CONSOLE_LOG(console_print_debug, logging_level, __VA_ARGS__)
+#define CONSOLE_PRINT_DEBUG_NO_EOL(logging_level, ...) CONSOLE_LOG(console_print_debug_no_eol, logging_level, __VA_ARGS__)
+#define CONSOLE_PRINT_ERROR(logging_level, ...)        CONSOLE_LOG(console_print_error, logging_level, __VA_ARGS__)
+#define CONSOLE_PRINT_WARN(logging_level, ...)         CONSOLE_LOG(console_print_warn, logging_level, __VA_ARGS__)
+#define CONSOLE_PRINT_SUCCESS(logging_level, ...)      CONSOLE_LOG(console_print_success, logging_level, __VA_ARGS__)
+#define CONSOLE_BINLOG(logging_level, ...)             CONSOLE_LOG(console_binlog, logging_level, __VA_ARGS__)
+
 #define _STR(x) #x
 #define STR(x)  _STR(x)
 
@@ -186,6 +233,7 @@ typedef struct ConsoleMenuItem
     ConsoleMenuId_t          id;
     struct ConsoleMenu      *sub_menu;
     ConsoleFunctionPointer_t function_pointer;
+    unsigned int             use_count; /* Times the item was selected, ranks the most used section */
 } ConsoleMenuItem_t;
 
 typedef struct ConsoleMenu
@@ -197,6 +245,15 @@ typedef struct ConsoleMenu
     unsigned int        current_page;
     ConsoleMenuMode_e   mode;
     void (*updater)(void);
+    /* MENU_VIRTUAL menus only, copies the items [offset, offset + count) into items (fewer past the end) and returns
+     * the total number of items, which becomes menu_length */
+    unsigned int (*page_provider)(struct ConsoleMenu *menu, ConsoleMenuItem_t *items, unsigned int offset, unsigned int count);
+    /* MENU_MUTABLE and MENU_VIRTUAL menus, optional cheap check for whether the items need fetching again, e.g. by
+     * comparing a directory's modification time. Without it they're only fetched again when the menu is entered, after
+     * one of its functions runs, or after console_menu_mark_changed(). */
+    bool (*changed)(struct ConsoleMenu *menu);
+    unsigned int              generation; /* Bumped every time the items change, see console_menu_mark_changed() */
+    struct ConsoleMenuSearch *search;     /* Trigram index built by the first search, leave NULL */
 } ConsoleMenu_t;
 
 typedef struct ConsoleSelection
@@ -207,6 +264,13 @@ typedef struct ConsoleSelection
 
 typedef ConsoleSelection_t ConsoleSelections[];
 
+typedef struct ConsoleFrameStats
+{
+    size_t       bytes;        // Bytes handed to the sink
+    unsigned int sink_calls;   // Number of writes to the sink (or buffers queued in asynchronous mode)
+    unsigned int format_calls; // Number of printf style format calls made by the print family
+} ConsoleFrameStats_t;
+
 typedef struct ConsoleSettings
 {
     /* Splash screen settings */
@@ -222,6 +286,24 @@ typedef struct ConsoleSettings
     char (*get_char_fn)(void);
     void (*put_char_fn)(char);
     void (*put_string_fn)(const char *);
+    /* Optional span-based sink, preferred over put_string_fn when defined. Sinks must be safe to call from any thread
+     * that prints, each call carries whole lines. */
+    void (*write_fn)(const char *data, size_t length);
+    /* Optional, called with true before a prompt reads a whole line from stdin and with false afterwards, so a backend
+     * that keeps the terminal in single key mode can hand it back to the line discipline in between. */
+    void (*line_mode_fn)(bool enable);
+    /* Optional, waits up to timeout_ms (negative waits forever) for a key and returns '\0' on timeout. Enables
+     * console_wait_for_key() and a non-blocking console_check_for_key(). */
+    char (*wait_for_char_fn)(int timeout_ms);
+    /* Optional, tells whether input has run out for good (get_char_fn and wait_for_char_fn then return '\0'). From
+     * then on every key reads as 'q', so the menus unwind and console_main() returns. */
+    bool (*input_ended_fn)(void);
+    /* Full screen mode, menu pages are redrawn in place by rewriting only the lines that changed. Needs a VT100 style
+     * terminal at least CONSOLE_WIDTH wide, console_init() falls back to appending pages when stdout isn't one. */
+    bool full_screen;
+    /* Number of most used items listed at the top of each menu page, selected with 'A', 'B'... wherever they are in
+     * the menu. 0 leaves the section out, at most MENU_MOST_USED_MAX. */
+    unsigned int most_used_length;
 } ConsoleSettings_t;
 
 #define TABLE_CELL_NO_OPTIONS (0)
@@ -264,28 +346,120 @@ typedef struct TableColumn
     TableCellOptions_t *options; /* Cell options */
 } TableColumn_t;
 
+typedef enum TableOverflowPolicy
+{
+    TABLE_OVERFLOW_TRUNCATE = 0, // Cells wider than their column are cut short and marked with a '~'
+    TABLE_OVERFLOW_EXPAND   = 1, // Cells wider than their column are printed in full, pushing the rest of the row out
+} TableOverflowPolicy_e;
+
+typedef struct TableStreamColumn
+{
+    const char *header; /* Column's header string */
+    TypeEnum_e  type;   /* Data type of the column */
+    size_t      width;  /* Fixed content width of the column, 0 to estimate it from the sampled rows */
+} TableStreamColumn_t;
+
+/* Supplies a streamed table's rows: point values[i] at a single value of column i's type (for TYPE_STRING, a pointer to
+ * the char *), optionally fill in options[i], and return false once there are no more rows. */
+typedef bool (*TableRowFetcher_t)(void *context, unsigned long row, void *values[], TableCellOptions_t options[]);
+
+typedef struct TableStream
+{
+    TableStreamColumn_t  *columns;         /* The table's columns */
+    int                   num_columns;     /* The number of columns */
+    TableRowFetcher_t     fetch_row;       /* Row supplier */
+    void                 *context;         /* Passed through to fetch_row */
+    unsigned int          sample_rows;     /* Rows buffered up front to estimate the width of columns with width 0 */
+    TableOverflowPolicy_e overflow_policy; /* What to do with cells wider than their column */
+} TableStream_t;
+
+typedef struct ConsoleDashboardCell
+{
+    unsigned int column;                    /* Screen column the cell starts at (0 based) */
+    unsigned int width;                     /* Printable width the cell is padded or cut to */
+    bool         dirty;                     /* Needs repainting */
+    char         text[DASHBOARD_CELL_SIZE]; /* Current contents */
+} ConsoleDashboardCell_t;
+
+typedef struct ConsoleDashboardLine
+{
+    bool                   dirty;                      /* The whole line needs repainting */
+    unsigned int           num_cells;                  /* Number of cells used on this line */
+    char                   text[STRING_BUFFER_SIZE];   /* Line contents, cells are drawn over them */
+    ConsoleDashboardCell_t cells[DASHBOARD_MAX_CELLS]; /* Cells, keyed by column */
+} ConsoleDashboardLine_t;
+
+/* A region of lines updated in place, see console_dashboard_open() */
+typedef struct ConsoleDashboard
+{
+    LoggingLevel_e          logging_level;     /* The logging level for the region */
+    ConsoleDashboardLine_t *lines;             /* The region's lines */
+    unsigned int            num_lines;         /* The number of lines in the region */
+    uint64_t                frame_interval_ns; /* Minimum time between repaints, 0 for no limit */
+    uint64_t                last_paint_ns;     /* When the region was last repainted */
+    bool                    dirty;             /* Something needs repainting */
+} ConsoleDashboard_t;
+
+/* A progress and throughput meter, see console_progress_start() (opaque, the counter is updated atomically) */
+typedef struct ConsoleProgress ConsoleProgress_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /* Main functions */
-void console_init(ConsoleSettings_t *settings);
-void console_main(void);
-void console_traverse_menus(ConsoleMenu_t *menu);
+void             console_init(ConsoleSettings_t *settings);
+void             console_main(void);
+void             console_traverse_menus(ConsoleMenu_t *menu);
+FunctionResult_e console_run_script(FILE *script);
+void             console_menu_mark_changed(ConsoleMenu_t *menu);
+const char      *console_get_function_result_string(FunctionResult_e result);
+
+/* Menu paths */
+FunctionResult_e console_menu_find(const char *path, ConsoleMenu_t **menu, ConsoleMenuItem_t **item);
+FunctionResult_e console_menu_invoke(const char *path);
+unsigned int     console_menu_search(ConsoleMenu_t *menu, const char *query, unsigned int *results, unsigned int max_results);
 
 /* Settings functions */
 void console_small_headers(bool enable);
 
+/* Asynchronous logging */
+FunctionResult_e console_async_start(unsigned int queue_length, ConsoleAsyncOverflow_e overflow_policy);
+void             console_async_stop(void);
+void             console_async_flush(void);
+uint64_t         console_async_get_drop_count(void);
+
+/* Built-in POSIX input backend, for os_init_fn, get_char_fn, line_mode_fn, wait_for_char_fn and input_ended_fn */
+FunctionResult_e console_posix_input_init(void);
+char             console_posix_get_char(void);
+char             console_posix_wait_for_char(int timeout_ms);
+bool             console_posix_input_ended(void);
+void             console_posix_line_mode(bool enable);
+
+/* Binary logging */
+FunctionResult_e console_binlog_start(unsigned int ring_length);
+void             console_binlog_stop(void);
+void             console_binlog(LoggingLevel_e logging_level, const char *format, ...);
+unsigned int     console_binlog_drain(void);
+unsigned int     console_binlog_dump(FILE *file);
+size_t           console_binlog_format(char *buffer, size_t buff_size, const char *format, const uint8_t *args, size_t args_size);
+uint64_t         console_binlog_get_drop_count(void);
+
 /* Prompting options */
 void         console_prompt_for_any_keys_blocking(void);
 char         console_check_for_key_blocking(void);
 char         console_check_for_key(void);
+char         console_wait_for_key(int timeout_ms);
 uint32_t     console_prompt_for_hex_uint32(const char *prompt, uint32_t default_val);
 uint64_t     console_prompt_for_hex_uint64(const char *prompt, uint64_t default_val);
 unsigned int console_prompt_for_int(const char *prompt, unsigned int default_val);
 char        *console_prompt_for_string(const char *prompt, const char *default_val);
 
 /* Core printing options */
+void           console_flush(void);
+void           console_frame_begin(void);
+void           console_frame_end(void);
+void           console_get_frame_stats(ConsoleFrameStats_t *stats);
 char           console_print_options_and_get_response(const ConsoleSelection_t selections[], unsigned int num_selections, unsigned int num_menu_selections, unsigned int option_flags);
 void           console_print(LoggingLevel_e logging_level, const char *format, ...);
 void           console_print_in_place(LoggingLevel_e logging_level, const char *format, ...);
@@ -308,20 +482,38 @@ void           console_print_divider(LoggingLevel_e logging_level);
 void           console_print_menu(ConsoleMenu_t *menu);
 unsigned int   console_get_string_buffer_index(void);
 LoggingLevel_e console_get_logging_level(void);
+bool           console_logging_enabled(LoggingLevel_e logging_level);
 
 /* Table printing functions */
 void                console_print_table_divider(LoggingLevel_e logging_level, size_t *column_widths, int num_columns);
 void                console_sprint_table_format_entry(char *buffer, size_t buff_size, TypeEnum_e type, void *data, TableCellOptions_t *options, int index);
 TableCellOptions_t *console_get_table_cell_options_array(int num_rows, TableCellOptions_e default_options, TableCellHighlight_e default_highlight);
 void                console_print_table(LoggingLevel_e logging_level, int num_rows, int num_columns, ...);
+unsigned long       console_print_table_stream(LoggingLevel_e logging_level, TableStream_t *stream);
+
+/* Dashboards */
+FunctionResult_e console_dashboard_open(ConsoleDashboard_t *dashboard, LoggingLevel_e logging_level, unsigned int num_lines, unsigned int max_fps);
+void             console_dashboard_set_line(ConsoleDashboard_t *dashboard, unsigned int line, const char *format, ...);
+void             console_dashboard_set_cell(ConsoleDashboard_t *dashboard, unsigned int line, unsigned int column, unsigned int width, const char *format, ...);
+bool             console_dashboard_refresh(ConsoleDashboard_t *dashboard);
+void             console_dashboard_close(ConsoleDashboard_t *dashboard);
+
+/* Progress meters */
+ConsoleProgress_t *console_progress_start(LoggingLevel_e logging_level, const char *label, uint64_t total, unsigned int interval_ms, bool use_thread);
+void               console_progress_add(ConsoleProgress_t *progress, uint64_t amount);
+bool               console_progress_poll(ConsoleProgress_t *progress);
+void               console_progress_finish(ConsoleProgress_t *progress);
 
 /* Fundamental functions wrapped around the logging level */
 char console_get_char_internal(LoggingLevel_e logging_level);
 void console_put_char_internal(LoggingLevel_e logging_level, char c);
 void console_put_string_internal(LoggingLevel_e logging_level, const char *string);
+void console_write_internal(LoggingLevel_e logging_level, const char *data, size_t length);
+void console_print_padding_internal(LoggingLevel_e logging_level, char c, size_t count);
 
 /* Utility functions */
 size_t           console_isprint_str_len(const char *str);
+size_t           console_isprint_span_len(const char *str, size_t length, size_t max_printable, size_t *consumed);
 void             console_assert_warn(LoggingLevel_e logging_level, bool condition, const char *format, ...);
 FunctionResult_e console_assert_error(LoggingLevel_e logging_level, bool condition, const char *format, ...);
 void             console_assert_fatal(LoggingLevel_e logging_level, bool condition, const char *format, ...);
@@ -25,6 +25,7 @@
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #if defined(WIN32)
 #include <locale.h>
 #include <windows.h>
@@ -58,18 +59,18 @@ extern FunctionResult_e ExampleHelloFunc(int argc, char *argv[]);
 
 // Start of main menu definition
 ConsoleMenuItem_t main_menu_items[] = {
-    {{"One", "The first menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Two", "The second menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Three", "The third menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Four", "The fourth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Five", "The fifth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Six", "The sixth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Seven", "The seventh menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Eight", "The eight menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Nine", "The ninth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Ten", "The tenth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Eleven", "The eleventh menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
-    {{"Twelve", "The twelfth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER},
+    {{"One", "The first menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Two", "The second menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Three", "The third menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Four", "The fourth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Five", "The fifth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Six", "The sixth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Seven", "The seventh menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Eight", "The eight menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Nine", "The ninth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Ten", "The tenth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Eleven", "The eleventh menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
+    {{"Twelve", "The twelfth menu item"}, &sub_menu_0, NO_FUNCTION_POINTER, 0},
 };
 ConsoleMenu_t main_menu = {{"Main Menu", "This is the main menu."},
                            main_menu_items,
@@ -81,7 +82,7 @@ ConsoleMenu_t main_menu = {{"Main Menu", "This is the main menu."},
 
 // Start of a sub menu definition
 ConsoleMenuItem_t sub_menu_0_items[] = {
-    {{"Hello", "Call the hello function!"}, NO_SUB_MENU, ExampleHelloFunc},
+    {{"Hello", "Call the hello function!"}, NO_SUB_MENU, ExampleHelloFunc, 0},
 };
 ConsoleMenu_t sub_menu_0 = {{"Sub Menu", "Sub menu shared by all."},
                             sub_menu_0_items,
@@ -91,6 +92,9 @@ ConsoleMenu_t sub_menu_0 = {{"Sub Menu", "Sub menu shared by all."},
                             NO_FUNCTION_POINTER};
 // End of a sub menu definition
 
+// Keys come from a script instead of the terminal, see --script
+static FILE *script_file = NULL;
+
 // Define these based on the platform you're working on
 FunctionResult_e console_os_init(void) {
   FunctionResult_e result = FR_OK;
@@ -126,30 +130,27 @@ FunctionResult_e console_os_init(void) {
            handle, GetLastError());
     return result;
   }
+#elif defined(__linux__) || defined(__APPLE__)
+  /* Single character entry for the whole session, see console_posix_input_init() */
+  if (script_file) {
+    return result;
+  }
+  result = console_posix_input_init();
+  if (result != FR_OK) {
+    printf("Warning: console_posix_input_init() returned %d\n", result);
+  }
 #endif /* defined(WIN32) */
   return result;
 }
 
 // Definitions to enable console.h to to its thing
+#if defined(WIN32)
 char console_get_char(void) {
   char c;
-  int result = 0;
-#if defined(WIN32)
   DWORD mode;
   HANDLE handle;
-#endif
 
-/* Enable single character entry */
-#if defined(__linux__) || defined(__APPLE__)
-  result = system("/bin/stty raw");
-  if (result != 0) {
-    console_print_error(
-        LOGGING_LEVEL_0,
-        "%s: Fatal Error: system(\"/bin/stty raw\") returned %d", __FUNCTION__,
-        result);
-    exit(FR_FAIL);
-  }
-#elif defined(WIN32)
+  /* Enable single character entry */
   handle = GetStdHandle(STD_INPUT_HANDLE);
   if (handle == INVALID_HANDLE_VALUE) {
     exit(GetLastError());
@@ -158,35 +159,34 @@ char console_get_char(void) {
     exit(GetLastError());
   }
   SetConsoleMode(handle, mode & ~(ENABLE_ECHO_INPUT | ENABLE_LINE_INPUT));
-#endif /* defined(WIN32) */
 
+  // Printable keys, plus Enter and backspace for searching the menus
   do {
     c = getc(stdin);
-  } while (!isalpha(c) && !isdigit(c));
-
-/* Disable single character entry */
-#if defined(__linux__) || defined(__APPLE__)
-  result = system("/bin/stty cooked");
-  if (result != 0) {
-    console_print_error(
-        LOGGING_LEVEL_0,
-        "%s: Fatal Error: system(\"/bin/stty cooked\") returned %d",
-        __FUNCTION__, result);
-    exit(FR_FAIL);
-  }
-#elif defined(WIN32)
+    if (c == '\r') {
+      c = '\n';
+    }
+  } while (!isprint(c) && (c != '\n') && (c != '\b'));
+
+  /* Disable single character entry */
   if (!SetConsoleMode(handle, mode)) {
     exit(GetLastError());
   }
-#endif /* defined(WIN32) */
 
   return c;
 }
+#endif /* defined(WIN32) */
 
 void console_put_char(char c) { putc(c, stdout); }
 
 void console_put_string(const char *string) { printf("%s", string); }
 
+// The console batches its output, so each call here is a whole frame's worth
+void console_write(const char *data, size_t length) {
+  fwrite(data, 1, length, stdout);
+  fflush(stdout);
+}
+
 // An example function
 FunctionResult_e ExampleHelloFunc(int argc, char *argv[]) {
   console_print(LOGGING_LEVEL_0, "Hello! How do you do?");
@@ -195,6 +195,7 @@ FunctionResult_e ExampleHelloFunc(int argc, char *argv[]) {
 }
 
 int main(int argc, char *argv[]) {
+  const char *run_path = NULL;
   // Setup console interface
   ConsoleSettings_t console_settings = {
       .splash_screen_pointer = &splash_screen,
@@ -202,13 +203,54 @@ int main(int argc, char *argv[]) {
       .small_headers = false,
       .logging_level = LOGGING_LEVEL_0,
       .os_init_fn = console_os_init,
+#if defined(WIN32)
       .get_char_fn = console_get_char,
+#else
+      .get_char_fn = console_posix_get_char,
+      .line_mode_fn = console_posix_line_mode,
+      .wait_for_char_fn = console_posix_wait_for_char,
+      .input_ended_fn = console_posix_input_ended,
+#endif
       .put_char_fn = console_put_char,
       .put_string_fn = console_put_string,
+      .write_fn = console_write,
+      .most_used_length = 3,
   };
+  for (int i = 1; i < argc; i++) {
+    // Redraw menus in place instead of scrolling (ignored if the terminal can't)
+    if (!strcmp(argv[i], "--full-screen")) {
+      console_settings.full_screen = true;
+    }
+    // Call the menu item at a path such as "Main Menu/Sub Menu/Hello" and exit
+    // with its result, without going through the menus
+    else if (!strcmp(argv[i], "--run") && (i + 1 < argc)) {
+      run_path = argv[++i];
+    }
+    // Run headless, reading keys from a file ("-" for stdin) and exiting
+    // non-zero if any function fails
+    else if (!strcmp(argv[i], "--script") && (i + 1 < argc)) {
+      i++;
+      script_file = strcmp(argv[i], "-") ? fopen(argv[i], "r") : stdin;
+      if (!script_file) {
+        printf("Couldn't open script %s\n", argv[i]);
+        return 1;
+      }
+    }
+  }
   console_init(&console_settings);
+  if (run_path) {
+    FunctionResult_e result = console_menu_invoke(run_path);
+    console_print(LOGGING_LEVEL_0, "%s: %s", run_path,
+                  console_get_function_result_string(result));
+    console_flush();
+    exit(result == FR_OK ? 0 : 1);
+  }
+  if (script_file) {
+    exit(console_run_script(script_file) == FR_OK ? 0 : 1);
+  }
   // Erase screen
   console_print(LOGGING_LEVEL_0, ERASE_SCREEN);
-  // Start console interface
-  console_main(); // Does not return
+  // Start console interface, returns once the user quits or input runs out
+  console_main();
+  return 0;
 }
\ No newline at end of file
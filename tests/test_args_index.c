@@ -0,0 +1,160 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Option name index test. Options are indexed by name and options array, so a main group and a function's group
+ * sharing an option name must each resolve to their own option, the first of two options sharing a name in one array
+ * must win as with a linear search, arrays that were never registered must still be searched, and options must still
+ * resolve after the index has grown past its initial 64 entries.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "args.h"
+#include "console.h"
+
+#define MANY_OPTIONS (100)
+#define NAME_LENGTH  (16)
+
+static FunctionResult_e test_function(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    return FR_OK;
+}
+
+static int  main_count      = 0;
+static int  main_duplicate  = 0;
+static bool main_verbose    = false;
+static int  function_count  = 0;
+static int  loose_count     = 0;
+static int  loose_other     = 0;
+static int  many_values[MANY_OPTIONS];
+static char many_names[MANY_OPTIONS][NAME_LENGTH];
+
+/* "count" is in both groups, and twice in the main one */
+static CliOptions_t main_options[] = {
+    {"verbose", "Be verbose", ARG_TYPE_NO_ARGUMENT, OPTION_TYPE_FLAG, &main_verbose, false, NULL, NULL},
+    {"count", "How many", ARG_TYPE_REQUIRED_ARGUMENT, OPTION_TYPE_INT, &main_count, false, NULL, NULL},
+    {"function", "Run the function", ARG_TYPE_NO_ARGUMENT, OPTION_TYPE_FUNC_PTR, (void *)test_function, false, NULL, NULL},
+    {"count", "How many, again", ARG_TYPE_REQUIRED_ARGUMENT, OPTION_TYPE_INT, &main_duplicate, false, NULL, NULL},
+    {0},
+};
+static CliOptionGroup_t main_group = {"Main options", NULL, main_options};
+
+static CliOptions_t function_options[] = {
+    {"count", "How many times to run", ARG_TYPE_REQUIRED_ARGUMENT, OPTION_TYPE_INT, &function_count, false, NULL, NULL},
+    {0},
+};
+static CliOptionGroup_t function_group = {"Function options", NULL, function_options};
+
+/* Never registered */
+static CliOptions_t loose_options[] = {
+    {"count", "How many", ARG_TYPE_REQUIRED_ARGUMENT, OPTION_TYPE_INT, &loose_count, false, NULL, NULL},
+    {"other", "Something else", ARG_TYPE_REQUIRED_ARGUMENT, OPTION_TYPE_INT, &loose_other, false, NULL, NULL},
+    {0},
+};
+
+static CliOptions_t     many_options[MANY_OPTIONS + 1];
+static CliOptionGroup_t many_group = {"Many options", NULL, many_options};
+
+static void test_sink(const char *data, size_t length)
+{
+    (void)data;
+    (void)length;
+}
+
+static unsigned int test_get(const char *name, CliOptions_t *options, CliOptions_t *expected, const char *description)
+{
+    if (args_get_option(name, options) != expected)
+    {
+        fprintf(stderr, "\"%s\" in %s not found where expected\n", name, description);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    ConsoleSettings_t settings = {
+        .logging_level = LOGGING_LEVEL_0,
+        .write_fn      = test_sink,
+    };
+    unsigned int failures = 0;
+
+    console_init(&settings);
+    args_register_options(&main_group, NULL);
+    args_register_options(&function_group, test_function);
+
+    /* Each array gets its own "count", the first of the main group's two */
+    failures += test_get("count", main_options, &main_options[1], "the main group");
+    failures += test_get("count", function_options, &function_options[0], "the function's group");
+    failures += test_get("verbose", main_options, &main_options[0], "the main group");
+    failures += test_get("verbose", function_options, NULL, "the function's group");
+    args_set_int_value("count", function_options, 7);
+    args_set_int_value("count", main_options, 3);
+    if ((function_count != 7) || (main_count != 3) || (main_duplicate != 0))
+    {
+        fprintf(stderr, "Setting \"count\" reached the wrong options (main %d, duplicate %d, function %d)\n", main_count, main_duplicate,
+                function_count);
+        failures++;
+    }
+
+    /* An array that was never registered is searched, and doesn't pick up a registered array's options */
+    failures += test_get("count", loose_options, &loose_options[0], "an unregistered array");
+    failures += test_get("other", loose_options, &loose_options[1], "an unregistered array");
+    failures += test_get("missing", loose_options, NULL, "an unregistered array");
+    if (args_get_int_value("other", loose_options) != 0)
+    {
+        fprintf(stderr, "\"other\" in an unregistered array has the wrong value\n");
+        failures++;
+    }
+
+    /* Enough options to grow the index several times over, everything indexed before must survive the moves */
+    for (int i = 0; i < MANY_OPTIONS; i++)
+    {
+        snprintf(many_names[i], NAME_LENGTH, "option%d", i);
+        many_options[i] = (CliOptions_t){many_names[i], "One of many", ARG_TYPE_REQUIRED_ARGUMENT, OPTION_TYPE_INT, &many_values[i], false, NULL, NULL};
+    }
+    args_register_options(&many_group, NULL);
+    for (int i = 0; i < MANY_OPTIONS; i++)
+    {
+        failures += test_get(many_names[i], many_options, &many_options[i], "the large group");
+        args_set_int_value(many_names[i], many_options, i + 1);
+        if (many_values[i] != i + 1)
+        {
+            fprintf(stderr, "Setting \"%s\" didn't reach its option\n", many_names[i]);
+            failures++;
+        }
+    }
+    failures += test_get("count", main_options, &main_options[1], "the main group after growing");
+    failures += test_get("count", function_options, &function_options[0], "the function's group after growing");
+
+    printf("%s: option name index, %u failures\n", failures ? "FAIL" : "PASS", failures);
+
+    return failures ? 1 : 0;
+}
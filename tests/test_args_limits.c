@@ -0,0 +1,259 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Argument parser limits test. More option groups than the old fixed registry held are registered and a command line
+ * far longer than the old fixed argument ledger is parsed, then unrecognized options on either side of the ledger's
+ * 64-bit word boundaries must still be reported. The parser keeps its state for the life of the process, so each case
+ * runs in a child process of its own.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "args.h"
+#include "console.h"
+
+#define BIG_GROUPS        (16)
+#define BIG_OPTIONS       (3200)
+#define BIG_ARGUMENTS     (2 * BIG_GROUPS * BIG_OPTIONS)
+#define SMALL_GROUPS      (12)
+#define SMALL_OPTIONS     (20)
+#define SMALL_ARGUMENTS   (200)
+#define NAME_LENGTH       (24)
+
+static const int unknown_indices[] = {63, 64, 65, 130, SMALL_ARGUMENTS - 1};
+
+static int               output_fd = -1;
+static CliOptions_t     *options[BIG_GROUPS];
+static CliOptionGroup_t  groups[BIG_GROUPS];
+static char            (*names)[NAME_LENGTH];
+static char            (*arguments)[NAME_LENGTH];
+static char            **argv;
+
+static void test_sink(const char *data, size_t length)
+{
+    while (length)
+    {
+        ssize_t written = write(output_fd, data, length);
+        if (written <= 0)
+        {
+            return;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+}
+
+static void test_init(int num_groups, int options_per_group, OptionType_e option_type, ArgType_e arg_type, void *values, size_t value_size)
+{
+    ConsoleSettings_t settings = {
+        .logging_level = LOGGING_LEVEL_0,
+        .write_fn      = test_sink,
+    };
+
+    console_init(&settings);
+    names = malloc(sizeof(*names) * (size_t)num_groups * (size_t)options_per_group);
+    for (int g = 0; g < num_groups; g++)
+    {
+        options[g] = calloc((size_t)options_per_group + 1, sizeof(CliOptions_t));
+        for (int o = 0; o < options_per_group; o++)
+        {
+            char *name = names[g * options_per_group + o];
+
+            snprintf(name, NAME_LENGTH, "g%do%d", g, o);
+            options[g][o] = (CliOptions_t){name, "Test option", arg_type, option_type, (char *)values + (size_t)(g * options_per_group + o) * value_size,
+                                           false, NULL, NULL};
+        }
+        groups[g] = (CliOptionGroup_t){"Test group", NULL, options[g]};
+        args_register_options(&groups[g], NULL);
+    }
+}
+
+/* Every option of every group once with its own index as the value, 100k+ arguments */
+static int test_many_arguments(void)
+{
+    int *values = calloc(BIG_GROUPS * BIG_OPTIONS, sizeof(int));
+    int  failures = 0;
+
+    test_init(BIG_GROUPS, BIG_OPTIONS, OPTION_TYPE_INT, ARG_TYPE_REQUIRED_ARGUMENT, values, sizeof(int));
+
+    arguments = malloc(sizeof(*arguments) * BIG_ARGUMENTS);
+    argv      = malloc(sizeof(char *) * (BIG_ARGUMENTS + 1));
+    argv[0]   = "test_args_limits";
+    for (int i = 0; i < BIG_GROUPS * BIG_OPTIONS; i++)
+    {
+        /* Interleave the groups so every one of them is busy all along the command line */
+        int g = i % BIG_GROUPS;
+        int o = i / BIG_GROUPS;
+
+        snprintf(arguments[2 * i], NAME_LENGTH, "--g%do%d", g, o);
+        snprintf(arguments[2 * i + 1], NAME_LENGTH, "%d", g * BIG_OPTIONS + o);
+        argv[1 + 2 * i] = arguments[2 * i];
+        argv[2 + 2 * i] = arguments[2 * i + 1];
+    }
+
+    args_parse(BIG_ARGUMENTS + 1, argv, NULL, true);
+
+    for (int i = 0; i < BIG_GROUPS * BIG_OPTIONS; i++)
+    {
+        if (values[i] != i)
+        {
+            if (failures++ < 10)
+            {
+                fprintf(stderr, "Option %s is %d, expected %d\n", names[i], values[i], i);
+            }
+        }
+    }
+
+    return failures ? 1 : 0;
+}
+
+/* Flags from every group with unrecognized options at and around the ledger's word boundaries, help must list them */
+static int test_unrecognized(void)
+{
+    bool values[SMALL_GROUPS * SMALL_OPTIONS] = {0};
+    int  next_option                          = 0;
+
+    test_init(SMALL_GROUPS, SMALL_OPTIONS, OPTION_TYPE_FLAG, ARG_TYPE_NO_ARGUMENT, values, sizeof(bool));
+
+    arguments = malloc(sizeof(*arguments) * SMALL_ARGUMENTS);
+    argv      = malloc(sizeof(char *) * SMALL_ARGUMENTS);
+    argv[0]   = "test_args_limits";
+    for (int i = 1; i < SMALL_ARGUMENTS; i++)
+    {
+        bool unknown = false;
+
+        for (size_t u = 0; u < sizeof(unknown_indices) / sizeof(unknown_indices[0]); u++)
+        {
+            unknown |= (i == unknown_indices[u]);
+        }
+        if (unknown)
+        {
+            snprintf(arguments[i], NAME_LENGTH, "--unknown%d", i);
+        }
+        else
+        {
+            snprintf(arguments[i], NAME_LENGTH, "--%s", names[next_option]);
+            next_option++;
+        }
+        argv[i] = arguments[i];
+    }
+
+    /* Prints the errors and the help, then exits */
+    args_parse(SMALL_ARGUMENTS, argv, NULL, true);
+
+    return 1;
+}
+
+/* Run a case in a child process, collecting what it prints */
+static int test_run(int (*test)(void), char **output)
+{
+    int    pipe_fds[2];
+    size_t size   = 0;
+    size_t length = 0;
+    int    status;
+    pid_t  child;
+
+    if (pipe(pipe_fds) != 0)
+    {
+        return 1;
+    }
+    child = fork();
+    if (child == 0)
+    {
+        close(pipe_fds[0]);
+        output_fd = pipe_fds[1];
+        status    = test();
+        console_flush();
+        _exit(status);
+    }
+    close(pipe_fds[1]);
+
+    *output = NULL;
+    for (;;)
+    {
+        ssize_t result;
+
+        if (length + 4096 + 1 > size)
+        {
+            size    = (length + 4096 + 1) * 2;
+            *output = realloc(*output, size);
+        }
+        result = read(pipe_fds[0], &(*output)[length], 4096);
+        if (result <= 0)
+        {
+            break;
+        }
+        length += (size_t)result;
+    }
+    (*output)[length] = '\0';
+    close(pipe_fds[0]);
+
+    return ((waitpid(child, &status, 0) == child) && WIFEXITED(status)) ? WEXITSTATUS(status) : 1;
+}
+
+int main(void)
+{
+    char *output;
+    char  expected[64];
+    int   failures = 0;
+
+    if (test_run(test_many_arguments, &output) != 0)
+    {
+        fprintf(stderr, "Parsing %d arguments over %d groups failed:\n%s\n", BIG_ARGUMENTS, BIG_GROUPS, output);
+        failures++;
+    }
+    free(output);
+
+    if (test_run(test_unrecognized, &output) != FR_OK)
+    {
+        fprintf(stderr, "Parsing with unrecognized options didn't end in help\n");
+        failures++;
+    }
+    for (size_t u = 0; u < sizeof(unknown_indices) / sizeof(unknown_indices[0]); u++)
+    {
+        snprintf(expected, sizeof(expected), "\"--unknown%d\" is not a recognized option", unknown_indices[u]);
+        if (!strstr(output, expected))
+        {
+            fprintf(stderr, "Argument %d, \"--unknown%d\", wasn't reported\n", unknown_indices[u], unknown_indices[u]);
+            failures++;
+        }
+    }
+    if (strstr(output, "\"--g"))
+    {
+        fprintf(stderr, "A recognized option was reported:\n%s\n", output);
+        failures++;
+    }
+    free(output);
+
+    printf("%s: %d groups and %d arguments, unrecognized options up to argument %d, %d failures\n", failures ? "FAIL" : "PASS", BIG_GROUPS,
+           BIG_ARGUMENTS, SMALL_ARGUMENTS - 1, failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Asynchronous logging test. Threads print colored lines through a deliberately slow sink under each overflow policy
+ * and the captured output is checked: every line that makes it out must be whole (escape sequences included), each
+ * thread's lines must stay in order, and whatever is missing must be accounted for by the drop count.
+ *
+ * The queue races that dropping the oldest line can run into are too rare to hit by printing, so console.c is built into
+ * the test and a last case drives the queue by hand, with the test playing a slow producer and the writer.
+ */
+
+#include "console.c"
+#include "test_sink.h"
+
+#define NUM_THREADS      (4)
+#define LINES_PER_THREAD (5000)
+#define QUEUE_LENGTH     (64)
+
+static unsigned int test_policy(ConsoleAsyncOverflow_e policy, const char *name)
+{
+    unsigned int failures;
+    unsigned int lines;
+    uint64_t     drops;
+
+    if (console_async_start(QUEUE_LENGTH, policy) != FR_OK)
+    {
+        fprintf(stderr, "%s: couldn't start asynchronous logging\n", name);
+        return 1;
+    }
+    test_run_workers(NUM_THREADS);
+    console_async_flush();
+    drops = console_async_get_drop_count();
+    console_async_stop();
+
+    failures = test_check_lines(name, NUM_THREADS, policy != ASYNC_OVERFLOW_BLOCK, &lines);
+    if (lines + drops != NUM_THREADS * LINES_PER_THREAD)
+    {
+        fprintf(stderr, "%s: %u lines written and %llu dropped, expected %u in total\n", name, lines, (unsigned long long)drops,
+                NUM_THREADS * LINES_PER_THREAD);
+        failures++;
+    }
+
+    printf("%s: %s, %u lines written, %llu dropped, %u failures\n", failures ? "FAIL" : "PASS", name, lines,
+           (unsigned long long)drops, failures);
+
+    return failures;
+}
+
+static void *test_producer(void *arg)
+{
+    const char *message = (const char *)arg;
+
+    console_async_push_internal(message, strlen(message));
+
+    return NULL;
+}
+
+/* Pop everything queued as the writer would, each message must be the next one expected */
+static unsigned int test_drain(const char *const *expected, unsigned int num_expected, unsigned int *lines)
+{
+    unsigned int failures = 0;
+    unsigned int count    = 0;
+    char        *message  = NULL;
+    size_t       size     = 0;
+    size_t       length;
+
+    while (console_async_pop_internal(&message, &size, &length))
+    {
+        if ((count >= num_expected) || (length != strlen(expected[count])) || memcmp(message, expected[count], length))
+        {
+            fprintf(stderr, "drop oldest race: unexpected message \"%.*s\"\n", (int)length, message);
+            failures++;
+        }
+        count++;
+    }
+    if (count != num_expected)
+    {
+        fprintf(stderr, "drop oldest race: %u messages queued, expected %u\n", count, num_expected);
+        failures++;
+    }
+    free(message);
+    *lines += count;
+
+    return failures;
+}
+
+static unsigned int test_drop_oldest_race(void)
+{
+    static const char *const first[]  = {"1", "2", "3", "B"};
+    static const char *const second[] = {"C"};
+    struct timespec          settle   = {.tv_sec = 0, .tv_nsec = 50000000};
+    pthread_t                producer;
+    unsigned int             failures = 0;
+    unsigned int             lines    = 0;
+    uint64_t                 drops;
+
+    /* A queue of four records and no writer thread */
+    async_queue = (ConsoleAsyncRecord_t *)malloc(sizeof(ConsoleAsyncRecord_t) * 4);
+    if (!async_queue)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < 4; i++)
+    {
+        atomic_init(&async_queue[i].sequence, i);
+    }
+    async_queue_mask      = 3;
+    async_overflow_policy = ASYNC_OVERFLOW_DROP_OLDEST;
+    atomic_store(&async_enqueue_index, 0);
+    atomic_store(&async_dequeue_index, 0);
+    atomic_store(&async_drop_count, 0);
+
+    /* A slow producer has claimed every record but not published any, so the oldest message is still being written
+     * and there's nothing to drop until it's done */
+    atomic_store(&async_enqueue_index, 4);
+    pthread_create(&producer, NULL, test_producer, (void *)"B");
+    nanosleep(&settle, NULL);
+    if (console_async_get_drop_count() != 0)
+    {
+        fprintf(stderr, "drop oldest race: a drop was counted while the oldest message was still being written\n");
+        failures++;
+    }
+    for (size_t i = 0; i < 4; i++)
+    {
+        async_queue[i].data[0] = (char)('0' + i);
+        async_queue[i].length  = 1;
+        atomic_store(&async_queue[i].num_records, 1);
+        atomic_store(&async_queue[i].sequence, i + 1);
+    }
+    pthread_join(producer, NULL);
+    failures += test_drain(first, 4, &lines);
+
+    /* Now the queue looks full again, but the writer is busy emptying it: the records at the dequeue index read as
+     * already taken while the index itself hasn't moved on, which holds the producer in its attempt to drop one. The
+     * writer then finishes, so there's nothing left to drop but room for the message. */
+    atomic_store(&async_enqueue_index, 9);
+    atomic_store(&async_queue[5 & 3].sequence, 7);
+    pthread_create(&producer, NULL, test_producer, (void *)"C");
+    nanosleep(&settle, NULL);
+    for (size_t i = 0; i < 4; i++)
+    {
+        atomic_store(&async_queue[(5 + i) & 3].sequence, 9 + i);
+    }
+    atomic_store(&async_dequeue_index, 9);
+    pthread_join(producer, NULL);
+    failures += test_drain(second, 1, &lines);
+
+    drops = console_async_get_drop_count();
+    if (lines + drops != 6)
+    {
+        fprintf(stderr, "drop oldest race: %u messages written and %llu dropped, expected 6 in total\n", lines, (unsigned long long)drops);
+        failures++;
+    }
+    free(async_queue);
+    async_queue = NULL;
+
+    printf("%s: drop oldest race, %u messages written, %llu dropped, %u failures\n", failures ? "FAIL" : "PASS", lines,
+           (unsigned long long)drops, failures);
+
+    return failures;
+}
+
+int main(void)
+{
+    ConsoleSettings_t settings = {
+        .logging_level = LOGGING_LEVEL_0,
+        .write_fn      = test_sink,
+    };
+    unsigned int failures = 0;
+
+    /* Slow enough that the queue overflows, with lines longer than a queue record */
+    sink_delay            = 2000;
+    test_lines_per_thread = LINES_PER_THREAD;
+    test_payload_length   = 399;
+
+    console_init(&settings);
+    failures += test_policy(ASYNC_OVERFLOW_BLOCK, "block");
+    failures += test_policy(ASYNC_OVERFLOW_DROP_NEWEST, "drop newest");
+    failures += test_policy(ASYNC_OVERFLOW_DROP_OLDEST, "drop oldest");
+    failures += test_drop_oldest_race();
+    free(sink_data);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Binary logging test. Records are logged with console_binlog() and formatted back both by console_binlog_drain() and
+ * by the offline decoder reading a console_binlog_dump() file; either way every line must match snprintf() of the same
+ * format and arguments. A ring that overflows must keep the oldest records and count the rest as dropped, and a
+ * truncated dump must decode to the records before the cut and be reported as truncated.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "console.h"
+
+#define DECODER       "./umami-binlog-decode"
+#define MAX_LINES     (32)
+#define MAX_LINE_SIZE (256)
+#define RING_LENGTH   (64)
+#define SMALL_RING    (8)
+#define OVERFLOW      (20)
+
+static char   sink_data[65536];
+static size_t sink_used = 0;
+
+static char         expected[MAX_LINES][MAX_LINE_SIZE];
+static unsigned int num_expected = 0;
+
+static const char *test_string = "a string";
+static int         test_object = 0;
+
+/* Log a record and keep what snprintf makes of the same format and arguments */
+#define TEST_LOG(format, ...)                                                                         \
+    do                                                                                                \
+    {                                                                                                 \
+        console_binlog(LOGGING_LEVEL_0, format, __VA_ARGS__);                                         \
+        snprintf(expected[num_expected++], MAX_LINE_SIZE, format, __VA_ARGS__);                       \
+    } while (0)
+
+static void test_sink(const char *data, size_t length)
+{
+    if (sink_used + length < sizeof(sink_data))
+    {
+        memcpy(&sink_data[sink_used], data, length);
+        sink_used += length;
+    }
+}
+
+static void test_log_all(void)
+{
+    num_expected = 0;
+    TEST_LOG("%d apples and %u pears", -42, 42u);
+    TEST_LOG("%hhd %hd %hhu", 300, 70000, 511);
+    TEST_LOG("%ld %lld %zu %td %jd", -1234567890L, 1234567890123LL, (size_t)77, (ptrdiff_t)-5, (intmax_t)99);
+    TEST_LOG("%x %08X %#llx %o", 0xbeefu, 0xcafeu, 0x123456789abcULL, 8u);
+    TEST_LOG("%.3f %e %g %Lg", 3.14159, 0.000123, 1e20, (long double)2.5);
+    TEST_LOG("%*d|%-*.*f|", 6, 42, 10, 2, 1.5);
+    TEST_LOG("%c%c%c 100%%", 'a', 'b', 'c');
+    TEST_LOG("%s", test_string);
+    TEST_LOG("[%-12s] [%12s] [%.3s]", test_string, "right", "truncated");
+    TEST_LOG("%s=%d, %s=%s", "first", 1, "second", "");
+    TEST_LOG("%p %p", (void *)&test_object, (void *)NULL);
+}
+
+/* Compare lines against the expected ones, skipping each line's prefix up to and including the separator */
+static unsigned int test_compare(const char *name, char *text, const char *separator, unsigned int *count)
+{
+    unsigned int failures = 0;
+    char        *line;
+    char        *save;
+
+    *count = 0;
+    for (line = strtok_r(text, "\r\n", &save); line; line = strtok_r(NULL, "\r\n", &save))
+    {
+        char *message = strstr(line, separator);
+
+        if (!message || (*count >= num_expected) || strcmp(message + strlen(separator), expected[*count]))
+        {
+            fprintf(stderr, "%s: line %u is \"%s\", expected \"%s\"\n", name, *count, line, (*count < num_expected) ? expected[*count] : "");
+            failures++;
+        }
+        (*count)++;
+    }
+
+    return failures;
+}
+
+static unsigned int test_drain(void)
+{
+    unsigned int failures = 0;
+    unsigned int count;
+
+    test_log_all();
+    sink_used = 0;
+    console_binlog_drain();
+    console_flush();
+    sink_data[sink_used] = '\0';
+    failures += test_compare("drain", sink_data, "] ", &count);
+    if (count != num_expected)
+    {
+        fprintf(stderr, "drain: %u of %u records formatted\n", count, num_expected);
+        failures++;
+    }
+
+    return failures;
+}
+
+/* Run the decoder on a dump, returning its exit status and what it printed */
+static int test_decode(const char *path, char *output, size_t output_size)
+{
+    char   command[256];
+    FILE  *pipe;
+    size_t used = 0;
+    size_t got;
+
+    snprintf(command, sizeof(command), DECODER " %s 2>/dev/null", path);
+    pipe = popen(command, "r");
+    if (!pipe)
+    {
+        return -1;
+    }
+    while ((used < output_size - 1) && ((got = fread(&output[used], 1, output_size - 1 - used, pipe)) > 0))
+    {
+        used += got;
+    }
+    output[used] = '\0';
+
+    return pclose(pipe);
+}
+
+static unsigned int test_dump(void)
+{
+    char         path[] = "/tmp/test_binlog_XXXXXX";
+    char         output[8192];
+    unsigned int failures = 0;
+    unsigned int count;
+    unsigned int dumped;
+    long         size;
+    int          descriptor;
+    FILE        *file;
+
+    descriptor = mkstemp(path);
+    file       = (descriptor >= 0) ? fdopen(descriptor, "w+b") : NULL;
+    if (!file)
+    {
+        fprintf(stderr, "dump: couldn't create a dump file\n");
+        return 1;
+    }
+    test_log_all();
+    dumped = console_binlog_dump(file);
+    size   = ftell(file);
+    fclose(file);
+
+    if ((test_decode(path, output, sizeof(output)) != 0) || (dumped != num_expected))
+    {
+        fprintf(stderr, "dump: %u of %u records dumped, or the decoder failed\n", dumped, num_expected);
+        failures++;
+    }
+    failures += test_compare("dump", output, "] L0 ", &count);
+    if (count != num_expected)
+    {
+        fprintf(stderr, "dump: %u of %u records decoded\n", count, num_expected);
+        failures++;
+    }
+
+    /* Cut the last record short, everything before it must still decode */
+    if (truncate(path, size - 3) != 0)
+    {
+        fprintf(stderr, "truncated dump: couldn't truncate the dump file\n");
+        failures++;
+    }
+    else
+    {
+        if (test_decode(path, output, sizeof(output)) == 0)
+        {
+            fprintf(stderr, "truncated dump: the decoder didn't report the truncation\n");
+            failures++;
+        }
+        failures += test_compare("truncated dump", output, "] L0 ", &count);
+        if (count != num_expected - 1)
+        {
+            fprintf(stderr, "truncated dump: %u of %u records decoded\n", count, num_expected - 1);
+            failures++;
+        }
+    }
+    remove(path);
+
+    return failures;
+}
+
+static unsigned int test_overflow(void)
+{
+    unsigned int failures = 0;
+    unsigned int count;
+
+    console_binlog_stop();
+    if (console_binlog_start(SMALL_RING) != FR_OK)
+    {
+        fprintf(stderr, "overflow: couldn't restart binary logging\n");
+        return 1;
+    }
+
+    /* A full ring drops the newest records */
+    num_expected = 0;
+    for (int i = 0; i < OVERFLOW; i++)
+    {
+        console_binlog(LOGGING_LEVEL_0, "record %d of %s", i, test_string);
+        if (i < SMALL_RING)
+        {
+            snprintf(expected[num_expected++], MAX_LINE_SIZE, "record %d of %s", i, test_string);
+        }
+    }
+    sink_used = 0;
+    console_binlog_drain();
+    console_flush();
+    sink_data[sink_used] = '\0';
+    failures += test_compare("overflow", sink_data, "] ", &count);
+    if ((count != SMALL_RING) || (console_binlog_get_drop_count() != OVERFLOW - SMALL_RING))
+    {
+        fprintf(stderr, "overflow: %u records kept and %llu dropped, expected %u and %u\n", count,
+                (unsigned long long)console_binlog_get_drop_count(), SMALL_RING, OVERFLOW - SMALL_RING);
+        failures++;
+    }
+
+    return failures;
+}
+
+int main(void)
+{
+    ConsoleSettings_t settings = {
+        .logging_level = LOGGING_LEVEL_0,
+        .write_fn      = test_sink,
+    };
+    unsigned int failures = 0;
+
+    console_init(&settings);
+    if (console_binlog_start(RING_LENGTH) != FR_OK)
+    {
+        fprintf(stderr, "Couldn't start binary logging\n");
+        return 1;
+    }
+
+    failures += test_drain();
+    failures += test_dump();
+    failures += test_overflow();
+    console_binlog_stop();
+
+    printf("%s: binary log drain, dump and decode, %u failures\n", failures ? "FAIL" : "PASS", failures);
+
+    return failures ? 1 : 0;
+}
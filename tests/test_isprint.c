@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Printable length scanner test. console_isprint_span_len() counts plain text in bulk with SIMD where available and
+ * falls back to a scalar state machine around escape sequences, so random strings of printable text, control bytes and
+ * escape sequences are checked against a plain scalar reference at every offset, length and printable limit.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "console.h"
+
+#define NUM_STRINGS    (20000)
+#define MAX_STRING_LEN (300)
+
+/* The scanner's rules, one byte at a time: CSI sequences end on any byte outside 0x20-0x3f, OSC sequences on BEL */
+static size_t test_reference_len(const char *str, size_t length, size_t max_printable, size_t *consumed)
+{
+    enum
+    {
+        NONE,
+        ESC,
+        CSI,
+        OSC
+    } state                 = NONE;
+    size_t printable        = 0;
+    size_t i                = 0;
+
+    while ((i < length) && (printable < max_printable))
+    {
+        unsigned char c = (unsigned char)str[i++];
+
+        switch (state)
+        {
+            case NONE:
+                if (c == '\x1b')
+                {
+                    state = ESC;
+                }
+                else if ((c >= 0x20) && (c <= 0x7e))
+                {
+                    printable++;
+                }
+                break;
+            case ESC:
+                state = (c == '[') ? CSI : (c == ']') ? OSC : NONE;
+                break;
+            case CSI:
+                if ((c < 0x20) || (c > 0x3f))
+                {
+                    state = (c == '\x1b') ? ESC : NONE;
+                }
+                break;
+            case OSC:
+                if (c == '\a')
+                {
+                    state = NONE;
+                }
+                else if (c == '\x1b')
+                {
+                    state = ESC;
+                }
+                break;
+        }
+    }
+    *consumed = i;
+
+    return printable;
+}
+
+/* Mostly runs of plain text (so the bulk paths get used) broken up by escape sequences and the odd stray byte */
+static size_t test_random_string(char *str, size_t max_length)
+{
+    static const char *const pieces[] = {ANSI_COLOR_RED, ANSI_COLOR_RESET, "\x1b[1;38;5;208m", "\x1b[2J", "\x1b[10A", "\x1b]0;title\a",
+                                         "\x1b", "\x1b[", "\t", "\x7f", "\xc3\xa9", "\n"};
+    size_t                   length   = 0;
+    size_t                   target   = (size_t)rand() % (max_length + 1);
+
+    while (length < target)
+    {
+        if (rand() % 4)
+        {
+            size_t run = (size_t)rand() % 80;
+            for (size_t i = 0; (i < run) && (length < target); i++)
+            {
+                str[length++] = (char)(0x20 + rand() % 0x5f);
+            }
+        }
+        else
+        {
+            const char *piece = pieces[(size_t)rand() % (sizeof(pieces) / sizeof(pieces[0]))];
+            for (size_t i = 0; piece[i] && (length < target); i++)
+            {
+                str[length++] = piece[i];
+            }
+        }
+    }
+    str[length] = '\0';
+
+    return length;
+}
+
+int main(void)
+{
+    static char  buffer[MAX_STRING_LEN + 64];
+    unsigned int failures = 0;
+
+    srand(1);
+    for (unsigned int n = 0; n < NUM_STRINGS; n++)
+    {
+        /* Shift the string around so the vector loads see every alignment */
+        char  *str    = &buffer[n % 32];
+        size_t length = test_random_string(str, MAX_STRING_LEN);
+        size_t limits[] = {0, 1, 15, 16, 17, 31, 32, 33, 64, (size_t)rand() % (MAX_STRING_LEN + 1), SIZE_MAX};
+
+        for (size_t l = 0; l < sizeof(limits) / sizeof(limits[0]); l++)
+        {
+            size_t expected_consumed;
+            size_t expected = test_reference_len(str, length, limits[l], &expected_consumed);
+            size_t consumed;
+            size_t actual = console_isprint_span_len(str, length, limits[l], &consumed);
+
+            if ((actual != expected) || (consumed != expected_consumed))
+            {
+                if (failures < 10)
+                {
+                    fprintf(stderr, "String %u (length %zu, limit %zu): got %zu printable in %zu bytes, expected %zu in %zu\n", n, length,
+                            limits[l], actual, consumed, expected, expected_consumed);
+                }
+                failures++;
+            }
+        }
+
+        if (console_isprint_str_len(str) != test_reference_len(str, length, SIZE_MAX, &(size_t){0}))
+        {
+            if (failures < 10)
+            {
+                fprintf(stderr, "String %u (length %zu): console_isprint_str_len() disagrees\n", n, length);
+            }
+            failures++;
+        }
+    }
+
+    printf("%s: %u random strings, %u failures\n", failures ? "FAIL" : "PASS", NUM_STRINGS, failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Menu path index test. An item and the sub menu it leads to commonly share a name, so the same path names both; the
+ * sub menu's own items must still be indexed under it, and every kind of path must resolve to the right menu and item.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "console.h"
+
+extern ConsoleMenu_t test_main_menu;
+extern ConsoleMenu_t test_settings_menu;
+extern ConsoleMenu_t test_network_menu;
+
+static FunctionResult_e test_function(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    return FR_OK;
+}
+
+static ConsoleMenuItem_t test_network_items[] = {
+    {{"Address", "Set the address"}, NO_SUB_MENU, test_function, 0},
+    {{"Gateway", "Set the gateway"}, NO_SUB_MENU, test_function, 0},
+};
+ConsoleMenu_t test_network_menu = {
+    .id          = {"Network", "Network settings"},
+    .menu_items  = test_network_items,
+    .parent_menu = &test_settings_menu,
+    .menu_length = MENU_SIZE(test_network_items),
+    .mode        = MENU_DEFAULT,
+};
+
+/* "Settings" is an item leading to a menu also called "Settings", "Network" likewise one level down */
+static ConsoleMenuItem_t test_settings_items[] = {
+    {{"Network", "Network settings"}, &test_network_menu, NO_FUNCTION_POINTER, 0},
+    {{"Reset", "Reset everything"}, NO_SUB_MENU, test_function, 0},
+};
+ConsoleMenu_t test_settings_menu = {
+    .id          = {"Settings", "All the settings"},
+    .menu_items  = test_settings_items,
+    .parent_menu = &test_main_menu,
+    .menu_length = MENU_SIZE(test_settings_items),
+    .mode        = MENU_DEFAULT,
+};
+
+static ConsoleMenuItem_t test_main_items[] = {
+    {{"Settings", "All the settings"}, &test_settings_menu, NO_FUNCTION_POINTER, 0},
+    {{"Hello", "Say hello"}, NO_SUB_MENU, test_function, 0},
+};
+ConsoleMenu_t test_main_menu = {
+    .id          = {"Main", "The main menu"},
+    .menu_items  = test_main_items,
+    .parent_menu = NO_MAIN_MENU,
+    .menu_length = MENU_SIZE(test_main_items),
+    .mode        = MENU_DEFAULT,
+};
+
+static void test_sink(const char *data, size_t length)
+{
+    (void)data;
+    (void)length;
+}
+
+static unsigned int test_find(const char *path, ConsoleMenu_t *expected_menu, ConsoleMenuItem_t *expected_item)
+{
+    ConsoleMenu_t     *menu = NULL;
+    ConsoleMenuItem_t *item = NULL;
+
+    if ((console_menu_find(path, &menu, &item) != FR_OK) || (menu != expected_menu) || (item != expected_item))
+    {
+        fprintf(stderr, "\"%s\" not found where expected\n", path);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    ConsoleSettings_t settings = {
+        .main_menu_pointer = &test_main_menu,
+        .logging_level     = LOGGING_LEVEL_0,
+        .write_fn          = test_sink,
+    };
+    unsigned int failures = 0;
+
+    console_init(&settings);
+
+    failures += test_find("Main", &test_main_menu, NULL);
+    failures += test_find("Main/Hello", &test_main_menu, &test_main_items[1]);
+    /* Both an item and a menu, the item wins */
+    failures += test_find("Main/Settings", &test_main_menu, &test_main_items[0]);
+    failures += test_find("Main/Settings/Network", &test_settings_menu, &test_settings_items[0]);
+    /* The sub menus' items are reachable below the shared names */
+    failures += test_find("Main/Settings/Reset", &test_settings_menu, &test_settings_items[1]);
+    failures += test_find("Main/Settings/Network/Address", &test_network_menu, &test_network_items[0]);
+    failures += test_find("Main/Settings/Network/Gateway", &test_network_menu, &test_network_items[1]);
+    if (console_menu_find("Main/Settings/Nowhere", NULL, NULL) != FR_NOTFOUND)
+    {
+        fprintf(stderr, "\"Main/Settings/Nowhere\" found\n");
+        failures++;
+    }
+    if (console_menu_invoke("Main/Settings/Network/Address") != FR_OK)
+    {
+        fprintf(stderr, "\"Main/Settings/Network/Address\" couldn't be invoked\n");
+        failures++;
+    }
+
+    printf("%s: menu path index, %u failures\n", failures ? "FAIL" : "PASS", failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,518 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Menu behaviour test. Each case drives its own menus through a script of keys, the way --script does, and checks
+ * which functions ran, what the items' use counts came to and, for menus whose items are fetched, how often that
+ * happened.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "console.h"
+
+#define SINK_SIZE  (1 << 20)
+#define CALLS_SIZE (512)
+
+static char   sink_data[SINK_SIZE];
+static size_t sink_used = 0;
+static char   calls[CALLS_SIZE]; /* The items whose functions ran, in order */
+
+static ConsoleSettings_t settings;
+
+static void test_sink(const char *data, size_t length)
+{
+    if (sink_used + length < SINK_SIZE)
+    {
+        memcpy(&sink_data[sink_used], data, length);
+        sink_used += length;
+    }
+}
+
+/* The menus pass the selected item's name as the first argument */
+static FunctionResult_e test_function(int argc, char *argv[])
+{
+    if (argc > 0)
+    {
+        strncat(calls, argv[0], CALLS_SIZE - strlen(calls) - 1);
+        strncat(calls, " ", CALLS_SIZE - strlen(calls) - 1);
+    }
+    return FR_OK;
+}
+
+static FunctionResult_e test_failing_function(int argc, char *argv[])
+{
+    test_function(argc, argv);
+    return FR_FAIL;
+}
+
+/* Script mode: functions in a menu and a sub menu, one of them failing, then a bad key */
+static ConsoleMenu_t     script_main_menu;
+static ConsoleMenu_t     script_sub_menu;
+static ConsoleMenuItem_t script_sub_items[] = {
+    {{"Gamma", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+};
+static ConsoleMenu_t script_sub_menu = {
+    .id          = {"Sub", "A sub menu"},
+    .menu_items  = script_sub_items,
+    .parent_menu = &script_main_menu,
+    .menu_length = MENU_SIZE(script_sub_items),
+    .mode        = MENU_DEFAULT,
+};
+static ConsoleMenuItem_t script_main_items[] = {
+    {{"Alpha", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Beta", "Fails"}, NO_SUB_MENU, test_failing_function, 0},
+    {{"Sub", "Leads to the sub menu"}, &script_sub_menu, NO_FUNCTION_POINTER, 0},
+};
+static ConsoleMenu_t script_main_menu = {
+    .id          = {"Main", "The main menu"},
+    .menu_items  = script_main_items,
+    .parent_menu = NO_MAIN_MENU,
+    .menu_length = MENU_SIZE(script_main_items),
+    .mode        = MENU_DEFAULT,
+};
+
+/* Search: two pages of items, found by name or description */
+static ConsoleMenuItem_t search_items[] = {
+    {{"Network address", "Set the address"}, NO_SUB_MENU, test_function, 0},
+    {{"Network gateway", "Set the gateway"}, NO_SUB_MENU, test_function, 0},
+    {{"Display brightness", "Set the brightness"}, NO_SUB_MENU, test_function, 0},
+    {{"Display contrast", "Set the contrast"}, NO_SUB_MENU, test_function, 0},
+    {{"Disk status", "Show the disks"}, NO_SUB_MENU, test_function, 0},
+    {{"Network status", "Show the links"}, NO_SUB_MENU, test_function, 0},
+    {{"Reboot", "Restart the machine"}, NO_SUB_MENU, test_function, 0},
+    {{"Shutdown", "Power off"}, NO_SUB_MENU, test_function, 0},
+    {{"Date and time", "Set the clock"}, NO_SUB_MENU, test_function, 0},
+    {{"Time zone", "Set the zone"}, NO_SUB_MENU, test_function, 0},
+    {{"Keyboard layout", "Set the layout"}, NO_SUB_MENU, test_function, 0},
+    {{"Mouse speed", "Set the pointer speed"}, NO_SUB_MENU, test_function, 0},
+};
+static ConsoleMenu_t search_menu = {
+    .id          = {"Settings", "Everything there is to set"},
+    .menu_items  = search_items,
+    .parent_menu = NO_MAIN_MENU,
+    .menu_length = MENU_SIZE(search_items),
+    .mode        = MENU_DEFAULT,
+};
+
+/* Virtual menus: three pages of records fetched a page at a time, from a main menu to go back to */
+#define VIRTUAL_LENGTH (25)
+
+static char          provided[CALLS_SIZE]; /* The offsets the page provider was asked for, in order */
+static ConsoleMenu_t virtual_main_menu;
+
+static unsigned int test_page_provider(ConsoleMenu_t *menu, ConsoleMenuItem_t *items, unsigned int offset, unsigned int count)
+{
+    (void)menu;
+    snprintf(&provided[strlen(provided)], CALLS_SIZE - strlen(provided), "%u/%u ", offset, count);
+    for (unsigned int i = 0; (i < count) && ((offset + i) < VIRTUAL_LENGTH); i++)
+    {
+        items[i] = (ConsoleMenuItem_t){{"", "A fetched record"}, NO_SUB_MENU, test_function, 0};
+        snprintf(items[i].id.name, sizeof(items[i].id.name), "Record%u", offset + i);
+    }
+    return VIRTUAL_LENGTH;
+}
+
+static ConsoleMenu_t virtual_menu = {
+    .id            = {"Records", "Fetched a page at a time"},
+    .parent_menu   = &virtual_main_menu,
+    .mode          = MENU_VIRTUAL,
+    .page_provider = test_page_provider,
+};
+static ConsoleMenuItem_t virtual_main_items[] = {
+    {{"Records", "Leads to the records"}, &virtual_menu, NO_FUNCTION_POINTER, 0},
+};
+static ConsoleMenu_t virtual_main_menu = {
+    .id          = {"Main", "The main menu"},
+    .menu_items  = virtual_main_items,
+    .parent_menu = NO_MAIN_MENU,
+    .menu_length = MENU_SIZE(virtual_main_items),
+    .mode        = MENU_DEFAULT,
+};
+
+/* Changes: a mutable menu whose items change on the third check, and an immutable menu renamed behind its back */
+static unsigned int updates = 0; /* Times the mutable menu's updater ran */
+static unsigned int checks  = 0; /* Times it was asked whether it changed */
+
+static void test_updater(void) { updates++; }
+
+static bool test_changed(ConsoleMenu_t *menu)
+{
+    (void)menu;
+    return (++checks == 3);
+}
+
+static ConsoleMenuItem_t mutable_items[] = {
+    {{"Alpha", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+};
+static ConsoleMenu_t mutable_menu = {
+    .id          = {"Live", "Updated when it changes"},
+    .menu_items  = mutable_items,
+    .parent_menu = NO_MAIN_MENU,
+    .menu_length = MENU_SIZE(mutable_items),
+    .mode        = MENU_MUTABLE,
+    .updater     = test_updater,
+    .changed     = test_changed,
+};
+static ConsoleMenuItem_t renamed_items[] = {
+    {{"Alpha", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Beta", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+};
+static ConsoleMenu_t renamed_menu = {
+    .id          = {"Renamed", "Renamed in place"},
+    .menu_items  = renamed_items,
+    .parent_menu = NO_MAIN_MENU,
+    .menu_length = MENU_SIZE(renamed_items),
+    .mode        = MENU_DEFAULT,
+};
+
+/* Go to and most used: two pages of items, the three most used of them picked by capitals */
+static ConsoleMenuItem_t goto_items[] = {
+    {{"Item0", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item1", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item2", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item3", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item4", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item5", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item6", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item7", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item8", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item9", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item10", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item11", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item12", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item13", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+    {{"Item14", "Succeeds"}, NO_SUB_MENU, test_function, 0},
+};
+static ConsoleMenu_t goto_menu = {
+    .id          = {"Items", "Two pages of them"},
+    .menu_items  = goto_items,
+    .parent_menu = NO_MAIN_MENU,
+    .menu_length = MENU_SIZE(goto_items),
+    .mode        = MENU_DEFAULT,
+};
+
+/* Type ahead: keys fed from a string, all of them typed before the first page could be drawn */
+static const char *keys = "";
+
+static char test_get_char(void) { return *keys ? *keys++ : '\0'; }
+
+static char test_wait_for_char(int timeout_ms)
+{
+    (void)timeout_ms;
+    return test_get_char();
+}
+
+static bool test_input_ended(void) { return *keys == '\0'; }
+
+static void test_init(ConsoleMenu_t *main_menu, unsigned int most_used_length)
+{
+    settings = (ConsoleSettings_t){
+        .main_menu_pointer = main_menu,
+        .logging_level     = LOGGING_LEVEL_0,
+        .write_fn          = test_sink,
+        .most_used_length  = most_used_length,
+    };
+    console_init(&settings);
+}
+
+static FunctionResult_e test_script(const char *script)
+{
+    FILE            *file = fmemopen((void *)script, strlen(script), "r");
+    FunctionResult_e result;
+
+    calls[0]  = '\0';
+    sink_used = 0;
+    result    = console_run_script(file);
+    fclose(file);
+    sink_data[sink_used] = '\0';
+
+    return result;
+}
+
+/* Scripts never type ahead, run the keys through the menus as if they were typed instead */
+static void test_type(ConsoleMenu_t *main_menu, const char *typed, bool wait_for_char)
+{
+    /* console_init() keeps its own copy of the settings, give it the keys along with the rest */
+    test_init(main_menu, 0);
+    settings.get_char_fn      = test_get_char;
+    settings.wait_for_char_fn = wait_for_char ? test_wait_for_char : NULL;
+    settings.input_ended_fn   = test_input_ended;
+    console_init(&settings);
+
+    keys        = typed;
+    calls[0]    = '\0';
+    provided[0] = '\0';
+    sink_used   = 0;
+    console_main();
+    sink_data[sink_used] = '\0';
+}
+
+static unsigned int test_count(const char *needle)
+{
+    unsigned int count = 0;
+
+    for (const char *found = strstr(sink_data, needle); found; found = strstr(found + 1, needle))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+static unsigned int test_calls(const char *name, const char *expected)
+{
+    if (strcmp(calls, expected))
+    {
+        fprintf(stderr, "%s: functions ran for \"%s\", expected \"%s\"\n", name, calls, expected);
+        return 1;
+    }
+
+    return 0;
+}
+
+static unsigned int test_uses(const char *name, const ConsoleMenuItem_t *item, unsigned int expected)
+{
+    if (item->use_count != expected)
+    {
+        fprintf(stderr, "%s: \"%s\" used %u times, expected %u\n", name, item->id.name, item->use_count, expected);
+        return 1;
+    }
+
+    return 0;
+}
+
+static unsigned int test_script_mode(void)
+{
+    unsigned int failures = 0;
+
+    test_init(&script_main_menu, 0);
+
+    /* The first failure is the script's result, every call is reported and the end of the script quits */
+    if (test_script("m 0 2 0 b 1 # quits from here\n") != FR_FAIL)
+    {
+        fprintf(stderr, "script mode: a failing function didn't fail the script\n");
+        failures++;
+    }
+    failures += test_calls("script mode", "Alpha Gamma Beta ");
+    if (!strstr(sink_data, " Main > Alpha: " ANSI_COLOR_GREEN "FR_OK") || !strstr(sink_data, " Sub > Gamma: " ANSI_COLOR_GREEN "FR_OK") ||
+        !strstr(sink_data, " Main > Beta: " ANSI_COLOR_RED "FR_FAIL") || !strstr(sink_data, " Script: "))
+    {
+        fprintf(stderr, "script mode: function calls or the summary weren't reported:\n%s\n", sink_data);
+        failures++;
+    }
+    failures += test_uses("script mode", &script_main_items[0], 1);
+    failures += test_uses("script mode", &script_main_items[1], 1);
+    failures += test_uses("script mode", &script_main_items[2], 1);
+    failures += test_uses("script mode", &script_sub_items[0], 1);
+
+    /* A key that isn't on the menu is skipped and makes the script invalid */
+    if (test_script("m 7 0") != FR_INVALID)
+    {
+        fprintf(stderr, "script mode: a bad key didn't make the script invalid\n");
+        failures++;
+    }
+    failures += test_calls("script mode", "Alpha ");
+    failures += test_uses("script mode", &script_main_items[0], 2);
+
+    return failures;
+}
+
+static unsigned int test_search(void)
+{
+    unsigned int failures = 0;
+
+    test_init(&search_menu, 0);
+
+    /* Results come in menu order and selecting one runs (and counts) the item it came from. Searching from the results
+     * searches the menu they came from, a search matching nothing leaves us where we were, and descriptions are
+     * searched too. */
+    if (test_script("m /status\n0 1 /NETWORK\n2 b /xyz\n/ness\n0 b /restart\n0") != FR_OK)
+    {
+        fprintf(stderr, "search: the script failed\n");
+        failures++;
+    }
+    failures += test_calls("search", "Disk status Network status Network status Display brightness Reboot ");
+    if (!strstr(sink_data, "No items match \"xyz\"") || !strstr(sink_data, " Search: status > Disk status: "))
+    {
+        fprintf(stderr, "search: a search went unreported:\n%s\n", sink_data);
+        failures++;
+    }
+    for (unsigned int i = 0; i < MENU_SIZE(search_items); i++)
+    {
+        unsigned int expected = (i == 5) ? 2 : ((i == 2) || (i == 4) || (i == 6)) ? 1 : 0;
+
+        failures += test_uses("search", &search_items[i], expected);
+    }
+
+    return failures;
+}
+
+static unsigned int test_virtual(void)
+{
+    unsigned int failures = 0;
+
+    test_init(&virtual_main_menu, 0);
+    provided[0] = '\0';
+
+    /* Only the page in view is fetched, when the menu is entered, the page changes or one of its functions ran. Keys
+     * that change nothing, like 'p' on the first page, fetch nothing. */
+    if (test_script("m 0 p n 3 n 1 p b 0") != FR_OK)
+    {
+        fprintf(stderr, "virtual: the script failed\n");
+        failures++;
+    }
+    failures += test_calls("virtual", "Record13 Record21 ");
+    if (strcmp(provided, "0/10 10/10 10/10 20/10 20/10 10/10 0/10 "))
+    {
+        fprintf(stderr, "virtual: pages fetched at \"%s\"\n", provided);
+        failures++;
+    }
+    failures += test_uses("virtual", &virtual_main_items[0], 2);
+
+    return failures;
+}
+
+static unsigned int test_changes(void)
+{
+    unsigned int failures = 0;
+
+    test_init(&mutable_menu, 0);
+
+    /* Updated on entry and after its function ran without asking, then asked once per key until it says it changed */
+    if (test_script("m 0 p p p") != FR_OK)
+    {
+        fprintf(stderr, "changes: the script failed\n");
+        failures++;
+    }
+    failures += test_calls("changes", "Alpha ");
+    failures += test_uses("changes", &mutable_items[0], 1);
+    if ((updates != 3) || (checks != 3))
+    {
+        fprintf(stderr, "changes: updated %u times after %u checks, expected 3 after 3\n", updates, checks);
+        failures++;
+    }
+
+    /* The search index of a menu renamed in place is only rebuilt once it's marked changed */
+    test_init(&renamed_menu, 0);
+    failures += (test_script("m /beta\n0") != FR_OK);
+    failures += test_calls("changes", "Beta ");
+    strcpy(renamed_items[1].id.name, "Gamma");
+    failures += (test_script("m /gamma") != FR_OK);
+    if (!strstr(sink_data, "No items match \"gamma\""))
+    {
+        fprintf(stderr, "changes: a stale index found a renamed item\n");
+        failures++;
+    }
+    console_menu_mark_changed(&renamed_menu);
+    failures += (test_script("m /gamma\n0") != FR_OK);
+    failures += test_calls("changes", "Gamma ");
+    failures += test_uses("changes", &renamed_items[1], 2);
+
+    return failures;
+}
+
+static unsigned int test_goto(void)
+{
+    unsigned int failures = 0;
+
+    test_init(&goto_menu, 3);
+
+    /* Items are gone to by their number in the menu, on whichever page, and then rank among the most used. Going to an
+     * item past the end is reported and changes nothing. */
+    if (test_script("m g12\ng12\ng3\ng99\nA B") != FR_OK)
+    {
+        fprintf(stderr, "go to: the script failed\n");
+        failures++;
+    }
+    failures += test_calls("go to", "Item12 Item12 Item3 Item12 Item3 ");
+    if (!strstr(sink_data, "Items has no item 99"))
+    {
+        fprintf(stderr, "go to: a missing item went unreported:\n%s\n", sink_data);
+        failures++;
+    }
+    failures += test_uses("go to", &goto_items[12], 3);
+    failures += test_uses("go to", &goto_items[3], 2);
+    failures += test_uses("go to", &goto_items[0], 0);
+
+    /* Only two items have been used, there's no third most used */
+    if (test_script("m C") != FR_INVALID)
+    {
+        fprintf(stderr, "go to: a capital past the most used wasn't a bad key\n");
+        failures++;
+    }
+    failures += test_calls("go to", "");
+
+    return failures;
+}
+
+static unsigned int test_typeahead(void)
+{
+    unsigned int failures = 0;
+
+    /* Typed ahead, the keys are applied without drawing the pages they pass through, only the page they leave us on */
+    virtual_menu.current_page = 0;
+    test_type(&virtual_main_menu, "m0nn3", true);
+    failures += test_calls("type ahead", "Record23 ");
+    if (strcmp(provided, "0/10 10/10 20/10 20/10 "))
+    {
+        fprintf(stderr, "type ahead: pages fetched at \"%s\"\n", provided);
+        failures++;
+    }
+    if ((test_count("The main menu") != 0) || (test_count("Fetched a page at a time") != 1))
+    {
+        fprintf(stderr, "type ahead: pages typed past were drawn:\n%s\n", sink_data);
+        failures++;
+    }
+
+    /* Without a way to check for keys every page is drawn */
+    virtual_menu.current_page = 0;
+    test_type(&virtual_main_menu, "m0nn3", false);
+    failures += test_calls("type ahead", "Record23 ");
+    if ((test_count("The main menu") != 1) || (test_count("Fetched a page at a time") != 4))
+    {
+        fprintf(stderr, "type ahead: pages were skipped:\n%s\n", sink_data);
+        failures++;
+    }
+
+    return failures;
+}
+
+int main(void)
+{
+    unsigned int failures = 0;
+
+    failures += test_script_mode();
+    failures += test_search();
+    failures += test_virtual();
+    failures += test_changes();
+    failures += test_goto();
+    failures += test_typeahead();
+
+    printf("%s: menu behaviour, %u failures\n", failures ? "FAIL" : "PASS", failures);
+
+    return failures ? 1 : 0;
+}
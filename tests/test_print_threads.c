@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Multi-threaded print stress test. Worker threads print numbered lines as fast as they can (using more string buffers
+ * per line than a single thread could ever share safely) and the captured output is checked for torn, interleaved or
+ * missing lines.
+ */
+
+#include "test_sink.h"
+
+#define NUM_THREADS      (8)
+#define LINES_PER_THREAD (20000)
+
+int main(void)
+{
+    ConsoleSettings_t settings = {
+        .logging_level = LOGGING_LEVEL_0,
+        .write_fn      = test_sink,
+    };
+    unsigned int failures;
+    unsigned int lines;
+
+    /* More string buffers per line than a single thread could ever share safely */
+    test_lines_per_thread = LINES_PER_THREAD;
+    test_payload_length   = 95;
+
+    console_init(&settings);
+    test_run_workers(NUM_THREADS);
+    console_flush();
+
+    failures = test_check_lines("print threads", NUM_THREADS, false, &lines);
+    if (lines != NUM_THREADS * LINES_PER_THREAD)
+    {
+        fprintf(stderr, "print threads: %u of %u lines seen\n", lines, NUM_THREADS * LINES_PER_THREAD);
+        failures++;
+    }
+
+    printf("%s: %u threads x %u lines, %u failures\n", failures ? "FAIL" : "PASS", NUM_THREADS, LINES_PER_THREAD, failures);
+    free(sink_data);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Fixture shared by the threaded print tests: a sink that captures everything written to it, workers that print
+ * numbered lines with a payload derived from the thread (so text from another thread is spotted), and a checker for
+ * the captured lines.
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "console.h"
+
+#define TEST_MAX_THREADS (8)
+#define TEST_MAX_PAYLOAD (512)
+
+static pthread_mutex_t sink_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char           *sink_data  = NULL;
+static size_t          sink_size  = 0;
+static size_t          sink_used  = 0;
+static long            sink_delay = 0; /* Nanoseconds each write takes, to make the sink slow */
+
+static unsigned int test_lines_per_thread = 0;
+static int          test_payload_length   = 0;
+
+static void test_sink(const char *data, size_t length)
+{
+    if (sink_delay)
+    {
+        struct timespec delay = {.tv_sec = 0, .tv_nsec = sink_delay};
+        nanosleep(&delay, NULL);
+    }
+
+    pthread_mutex_lock(&sink_mutex);
+    /* Keep room for the terminator the checker adds */
+    if (sink_used + length + 1 > sink_size)
+    {
+        sink_size = (sink_used + length + 1) * 2;
+        sink_data = realloc(sink_data, sink_size);
+        if (!sink_data)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    memcpy(&sink_data[sink_used], data, length);
+    sink_used += length;
+    pthread_mutex_unlock(&sink_mutex);
+}
+
+static void *test_worker(void *arg)
+{
+    unsigned int thread = (unsigned int)(size_t)arg;
+    char         payload[TEST_MAX_PAYLOAD];
+
+    memset(payload, 'a' + (int)thread, (size_t)test_payload_length);
+    payload[test_payload_length] = '\0';
+
+    for (unsigned int line = 0; line < test_lines_per_thread; line++)
+    {
+        console_print(LOGGING_LEVEL_0, "T%02u L%06u " ANSI_COLOR_RED "%s" ANSI_COLOR_RESET " %u", thread, line, payload, thread * line);
+    }
+
+    return NULL;
+}
+
+static void test_run_workers(unsigned int num_threads)
+{
+    pthread_t threads[TEST_MAX_THREADS];
+
+    sink_used = 0;
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        pthread_create(&threads[i], NULL, test_worker, (void *)i);
+    }
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+/*
+ * Check the captured lines: every line must be whole (escape sequences included) and each thread's lines must arrive in
+ * order, without gaps unless lines may have been dropped. Returns the number of failures and counts the lines seen.
+ */
+static unsigned int test_check_lines(const char *name, unsigned int num_threads, bool gaps_allowed, unsigned int *lines)
+{
+    unsigned int next_line[TEST_MAX_THREADS] = {0};
+    unsigned int failures = 0;
+    char         expected[TEST_MAX_PAYLOAD];
+    char        *line;
+    char        *save;
+
+    *lines = 0;
+    test_sink("", 0); /* Makes sure there's a buffer to terminate, even if nothing was written */
+    sink_data[sink_used] = '\0';
+    for (line = strtok_r(sink_data, "\r\n", &save); line; line = strtok_r(NULL, "\r\n", &save))
+    {
+        unsigned int thread;
+        unsigned int number;
+        unsigned int product;
+        char         payload[TEST_MAX_PAYLOAD];
+
+        if ((sscanf(line, "T%02u L%06u " ANSI_COLOR_RED "%511[a-z]" ANSI_COLOR_RESET " %u", &thread, &number, payload, &product) != 4) ||
+            (thread >= num_threads))
+        {
+            fprintf(stderr, "%s: malformed line: \"%s\"\n", name, line);
+            failures++;
+            continue;
+        }
+        memset(expected, 'a' + (int)thread, (size_t)test_payload_length);
+        expected[test_payload_length] = '\0';
+        if ((number < next_line[thread]) || strcmp(payload, expected) || (product != thread * number) ||
+            (!gaps_allowed && (number != next_line[thread])))
+        {
+            fprintf(stderr, "%s: unexpected line from thread %u (expected line %u%s): \"%s\"\n", name, thread, next_line[thread],
+                    gaps_allowed ? " or later" : "", line);
+            failures++;
+        }
+        next_line[thread] = number + 1;
+        (*lines)++;
+    }
+
+    return failures;
+}
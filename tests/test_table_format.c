@@ -0,0 +1,172 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+
+/*
+ * Table integer formatting test. Integer cells are formatted without printf, so for every integer type in
+ * console_type_lut the cell must match snprintf() with the type's format string, signed hex types included (printf sees
+ * those sign extended to 32 bits). console.c is built into the test to also check the formatters on their own against
+ * short buffers, where they must truncate the way snprintf() does.
+ */
+
+#include "console.c"
+
+static const int64_t test_values[] = {
+    0,         1,         -1,         9,         10,        99,        100,        -100,      12345, -12345,
+    INT8_MIN,  INT8_MAX,  UINT8_MAX,  INT16_MIN, INT16_MAX, UINT16_MAX, INT32_MIN, INT32_MAX, UINT32_MAX,
+    INT64_MIN, INT64_MAX, 0x0123456789abcdefLL,
+};
+
+static bool test_is_signed(TypeEnum_e type)
+{
+    return ((type >= TYPE_DEC_INT8) && (type <= TYPE_DEC_INT64)) || ((type >= TYPE_HEX_INT4) && (type <= TYPE_HEX_INT64));
+}
+
+static bool test_is_hex(TypeEnum_e type) { return type >= TYPE_HEX_INT4; }
+
+/* The value as a cell of the type holds it: cut down to the type's size, then sign or zero extended */
+static int64_t test_stored_value(TypeEnum_e type, int64_t value)
+{
+    bool is_signed = test_is_signed(type);
+
+    switch (console_type_lut[type].size)
+    {
+        case 1:
+            return is_signed ? (int8_t)value : (int64_t)(uint8_t)value;
+        case 2:
+            return is_signed ? (int16_t)value : (int64_t)(uint16_t)value;
+        case 4:
+            return is_signed ? (int32_t)value : (int64_t)(uint32_t)value;
+        default:
+            return value;
+    }
+}
+
+/* What printf makes of the value with the type's format string, values up to 32 bits go through as (unsigned) ints */
+static void test_expected(char *buffer, size_t buff_size, TypeEnum_e type, int64_t stored)
+{
+    const char *format = console_type_lut[type].format_string;
+
+    if (console_type_lut[type].size == 8)
+    {
+        snprintf(buffer, buff_size, format, stored);
+    }
+    else if (test_is_signed(type))
+    {
+        snprintf(buffer, buff_size, format, (int)stored);
+    }
+    else
+    {
+        snprintf(buffer, buff_size, format, (unsigned int)stored);
+    }
+}
+
+static unsigned int test_cell(TypeEnum_e type, int64_t value)
+{
+    int64_t      stored   = test_stored_value(type, value);
+    unsigned int failures = 0;
+    char         expected[64];
+    char         actual[64];
+    size_t       length;
+    union
+    {
+        int8_t  i8;
+        int16_t i16;
+        int32_t i32;
+        int64_t i64;
+    } cell;
+
+    switch (console_type_lut[type].size)
+    {
+        case 1:
+            cell.i8 = (int8_t)stored;
+            break;
+        case 2:
+            cell.i16 = (int16_t)stored;
+            break;
+        case 4:
+            cell.i32 = (int32_t)stored;
+            break;
+        default:
+            cell.i64 = stored;
+            break;
+    }
+
+    /* The whole cell, as the table prints it */
+    test_expected(expected, sizeof(expected), type, stored);
+    length = strlen(expected);
+    strcat(expected, ANSI_COLOR_RESET);
+    console_sprint_table_format_entry(actual, sizeof(actual), type, &cell, NULL, 0);
+    if (strcmp(actual, expected))
+    {
+        fprintf(stderr, "Type %d, value %" PRId64 ": \"%s\", expected \"%s\"\n", (int)type, value, actual, expected);
+        failures++;
+    }
+
+    /* The formatter on its own, into every buffer size up to one that fits */
+    for (size_t size = 1; size <= length + 1; size++)
+    {
+        memset(actual, '#', sizeof(actual));
+        test_expected(expected, size, type, stored);
+        if (!test_is_hex(type))
+        {
+            console_sprint_dec_internal(actual, size, test_is_signed(type) && (stored < 0), (uint64_t)stored);
+        }
+        else if (test_is_signed(type) && (console_type_lut[type].size < 8))
+        {
+            console_sprint_hex_internal(actual, size, (uint32_t)stored, console_type_lut[type].hex_digits);
+        }
+        else
+        {
+            console_sprint_hex_internal(actual, size, (uint64_t)stored, console_type_lut[type].hex_digits);
+        }
+        if (strcmp(actual, expected) || (actual[size] != '#'))
+        {
+            fprintf(stderr, "Type %d, value %" PRId64 ", %zu byte buffer: \"%.*s\", expected \"%s\"\n", (int)type, value, size,
+                    (int)size, actual, expected);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+int main(void)
+{
+    unsigned int failures = 0;
+    unsigned int cells    = 0;
+
+    for (int type = TYPE_DEC_INT8; type <= TYPE_HEX_UINT64; type++)
+    {
+        for (size_t i = 0; i < sizeof(test_values) / sizeof(test_values[0]); i++)
+        {
+            failures += test_cell((TypeEnum_e)type, test_values[i]);
+            cells++;
+        }
+    }
+
+    printf("%s: %u integer table cells, %u failures\n", failures ? "FAIL" : "PASS", cells, failures);
+
+    return failures ? 1 : 0;
+}